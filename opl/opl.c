@@ -42,6 +42,7 @@ static opl_driver_t *driver = NULL;
 static int init_stage_reg_writes = 1;
 
 unsigned int opl_sample_rate = 22050;
+int opl_render_mode = 0;
 
 //
 // Init/shutdown code.
@@ -473,6 +474,19 @@ void OPL_Delay(uint64_t us)
 
     OPL_SetCallback(us, DelayCallback, &delay_data);
 
+    // In render mode nothing else advances the clock, so generate
+    // (and throw away) samples until the callback is invoked.
+
+    if (opl_render_mode)
+    {
+        int16_t buffer[64 * 2];
+
+        while (!delay_data.finished)
+        {
+            OPL_Render(buffer, 64);
+        }
+    }
+
     // Wait until the callback is invoked.
 
     SDL_LockMutex(delay_data.mutex);
@@ -506,3 +520,21 @@ void OPL_AdjustCallbacks(float value)
     }
 }
 
+void OPL_SetRenderMode(int render)
+{
+    opl_render_mode = render;
+}
+
+void OPL_Render(int16_t *buffer, unsigned int nsamples)
+{
+#ifndef DISABLE_SDL2MIXER
+    if (driver == &opl_sdl_driver && opl_render_mode)
+    {
+        OPL_SDL_Render(buffer, nsamples);
+        return;
+    }
+#endif
+
+    memset(buffer, 0, nsamples * 4);
+}
+
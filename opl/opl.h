@@ -149,5 +149,16 @@ void OPL_Delay(uint64_t us);
 
 void OPL_SetPaused(int paused);
 
+// Render mode: no audio device is opened by OPL_Init, and time only
+// advances when samples are generated with OPL_Render. Must be set
+// before OPL_Init.
+
+void OPL_SetRenderMode(int render);
+
+// Generate nsamples of 16-bit stereo emulator output in render mode,
+// invoking callbacks as the virtual clock advances.
+
+void OPL_Render(int16_t *buffer, unsigned int nsamples);
+
 #endif
 
@@ -33,6 +33,12 @@
 
 #define RSM_FRAC    10
 
+// Number of chip samples generated slot by slot in a single batch.
+// Native samples buffered for resampling are limited by OPL_NATIVE_SIZE.
+
+#define OPL_BLOCK_SIZE  128
+#define OPL_NATIVE_SIZE 1024
+
 // Channel types
 
 enum {
@@ -357,7 +363,8 @@ static void OPL3_EnvelopeUpdateKSL(opl3_slot *slot)
     slot->eg_ksl = (Bit8u)ksl;
 }
 
-static void OPL3_EnvelopeCalc(opl3_slot *slot)
+static void OPL3_EnvelopeStep(opl3_slot *slot, Bit8u trem, Bit8u eg_add,
+                              Bit8u eg_state, Bit16u timer)
 {
     Bit8u nonzero;
     Bit8u rate;
@@ -371,7 +378,7 @@ static void OPL3_EnvelopeCalc(opl3_slot *slot)
     Bit8u eg_off;
     Bit8u reset = 0;
     slot->eg_out = slot->eg_rout + (slot->reg_tl << 2)
-                 + (slot->eg_ksl >> kslshift[slot->reg_ksl]) + *slot->trem;
+                 + (slot->eg_ksl >> kslshift[slot->reg_ksl]) + trem;
     if (slot->key && slot->eg_gen == envelope_gen_num_release)
     {
         reset = 1;
@@ -408,13 +415,13 @@ static void OPL3_EnvelopeCalc(opl3_slot *slot)
     {
         rate_hi = 0x0f;
     }
-    eg_shift = rate_hi + slot->chip->eg_add;
+    eg_shift = rate_hi + eg_add;
     shift = 0;
     if (nonzero)
     {
         if (rate_hi < 12)
         {
-            if (slot->chip->eg_state)
+            if (eg_state)
             {
                 switch (eg_shift)
                 {
@@ -434,14 +441,14 @@ static void OPL3_EnvelopeCalc(opl3_slot *slot)
         }
         else
         {
-            shift = (rate_hi & 0x03) + eg_incstep[rate_lo][slot->chip->timer & 0x03];
+            shift = (rate_hi & 0x03) + eg_incstep[rate_lo][timer & 0x03];
             if (shift & 0x04)
             {
                 shift = 0x03;
             }
             if (!shift)
             {
-                shift = slot->chip->eg_state;
+                shift = eg_state;
             }
         }
     }
@@ -504,6 +511,12 @@ static void OPL3_EnvelopeCalc(opl3_slot *slot)
     }
 }
 
+static void OPL3_EnvelopeCalc(opl3_slot *slot)
+{
+    OPL3_EnvelopeStep(slot, *slot->trem, slot->chip->eg_add,
+                      slot->chip->eg_state, slot->chip->timer);
+}
+
 static void OPL3_EnvelopeKeyOn(opl3_slot *slot, Bit8u type)
 {
     slot->key |= type;
@@ -518,24 +531,20 @@ static void OPL3_EnvelopeKeyOff(opl3_slot *slot, Bit8u type)
 // Phase Generator
 //
 
-static void OPL3_PhaseGenerate(opl3_slot *slot)
+// Advance phase of the slot, return phase before the step.
+
+static Bit16u OPL3_PhaseStep(opl3_slot *slot, Bit8u vibpos, Bit8u vibshift)
 {
-    opl3_chip *chip;
     Bit16u f_num;
     Bit32u basefreq;
-    Bit8u rm_xor, n_bit;
-    Bit32u noise;
     Bit16u phase;
 
-    chip = slot->chip;
     f_num = slot->channel->f_num;
     if (slot->reg_vib)
     {
         Bit8s range;
-        Bit8u vibpos;
 
         range = (f_num >> 7) & 7;
-        vibpos = slot->chip->vibpos;
 
         if (!(vibpos & 3))
         {
@@ -545,7 +554,7 @@ static void OPL3_PhaseGenerate(opl3_slot *slot)
         {
             range >>= 1;
         }
-        range >>= slot->chip->vibshift;
+        range >>= vibshift;
 
         if (vibpos & 4)
         {
@@ -560,6 +569,18 @@ static void OPL3_PhaseGenerate(opl3_slot *slot)
         slot->pg_phase = 0;
     }
     slot->pg_phase += (basefreq * mt[slot->reg_mult]) >> 1;
+    return phase;
+}
+
+static void OPL3_PhaseGenerate(opl3_slot *slot)
+{
+    opl3_chip *chip;
+    Bit8u rm_xor, n_bit;
+    Bit32u noise;
+    Bit16u phase;
+
+    chip = slot->chip;
+    phase = OPL3_PhaseStep(slot, chip->vibpos, chip->vibshift);
     // Rhythm mode
     noise = chip->noise;
     slot->pg_phase_out = phase;
@@ -1043,12 +1064,14 @@ static Bit16s OPL3_ClipSample(Bit32s sample)
     return (Bit16s)sample;
 }
 
+static void OPL3_ChipTick(opl3_chip *chip);
+static void OPL3_ProcessWriteBuf(opl3_chip *chip);
+
 void OPL3_Generate(opl3_chip *chip, Bit16s *buf)
 {
     Bit8u ii;
     Bit8u jj;
     Bit16s accm;
-    Bit8u shift = 0;
 
     buf[1] = OPL3_ClipSample(chip->mixbuff[1]);
 
@@ -1108,6 +1131,16 @@ void OPL3_Generate(opl3_chip *chip, Bit16s *buf)
         OPL3_SlotGenerate(&chip->slot[ii]);
     }
 
+    OPL3_ChipTick(chip);
+    OPL3_ProcessWriteBuf(chip);
+}
+
+// Advance tremolo, vibrato and envelope timers by one sample.
+
+static void OPL3_ChipTick(opl3_chip *chip)
+{
+    Bit8u shift = 0;
+
     if ((chip->timer & 0x3f) == 0x3f)
     {
         chip->tremolopos = (chip->tremolopos + 1) % 210;
@@ -1160,7 +1193,12 @@ void OPL3_Generate(opl3_chip *chip, Bit16s *buf)
     }
 
     chip->eg_state ^= 1;
+}
 
+// Apply buffered register writes which are due after this sample.
+
+static void OPL3_ProcessWriteBuf(opl3_chip *chip)
+{
     while (chip->writebuf[chip->writebuf_cur].time <= chip->writebuf_samplecnt)
     {
         if (!(chip->writebuf[chip->writebuf_cur].reg & 0x200))
@@ -1175,6 +1213,237 @@ void OPL3_Generate(opl3_chip *chip, Bit16s *buf)
     chip->writebuf_samplecnt++;
 }
 
+//
+// Batched generation
+//
+// Runs every slot through a whole block of samples before moving to the
+// next one, so the per-slot state stays in registers and the channel
+// mixing runs over flat arrays. Order of the hardware is kept: within a
+// sample, slots see outputs of lower slots from the same sample, and the
+// left/right mix sees slots 15-17/33-35 one sample late.
+//
+
+// Index of the slot whose output is at p, -1 for zero or -2 for
+// anything else.
+
+static int OPL3_OutSlot(opl3_chip *chip, Bit16s *p)
+{
+    Bit8u ii;
+
+    if (p == &chip->zeromod)
+    {
+        return -1;
+    }
+    for (ii = 0; ii < 36; ii++)
+    {
+        if (p == &chip->slot[ii].out)
+        {
+            return ii;
+        }
+    }
+    return -2;
+}
+
+// Rhythm mode couples slots 13, 16 and 17 through shared phase bits,
+// and a slot could be modulated by a later one after a 4-op setup
+// change. Such samples are left to OPL3_Generate.
+
+static int OPL3_CanBatch(opl3_chip *chip)
+{
+    Bit8u ii, jj;
+    int slotnum;
+
+    if (chip->rhy & 0x20)
+    {
+        return 0;
+    }
+    for (ii = 0; ii < 36; ii++)
+    {
+        opl3_slot *slot = &chip->slot[ii];
+
+        if (slot->mod != &slot->fbmod)
+        {
+            slotnum = OPL3_OutSlot(chip, slot->mod);
+            if (slotnum == -2 || slotnum >= ii)
+            {
+                return 0;
+            }
+        }
+    }
+    for (ii = 0; ii < 18; ii++)
+    {
+        for (jj = 0; jj < 4; jj++)
+        {
+            if (OPL3_OutSlot(chip, chip->channel[ii].out[jj]) == -2)
+            {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// Generate numsamples chip samples, which must be no more than
+// OPL_BLOCK_SIZE. No buffered write may be due before the last one.
+
+static void OPL3_GenerateBlock(opl3_chip *chip, Bit16s *buf, Bit32u numsamples)
+{
+    static const Bit16s zeros[OPL_BLOCK_SIZE + 1];
+    Bit16u timer[OPL_BLOCK_SIZE];
+    Bit8u eg_add[OPL_BLOCK_SIZE];
+    Bit8u eg_state[OPL_BLOCK_SIZE];
+    Bit8u tremolo[OPL_BLOCK_SIZE];
+    Bit8u vibpos[OPL_BLOCK_SIZE];
+    // Slot outputs, [0] is the output before the block.
+    Bit16s out[36][OPL_BLOCK_SIZE + 1];
+    Bit32s mixbuff[2][OPL_BLOCK_SIZE];
+    Bit16s accm[OPL_BLOCK_SIZE];
+    Bit32u i, n_bit;
+    Bit8u ii, jj;
+
+    // Timers don't depend on slots, step them through the whole block.
+    for (i = 0; i < numsamples; i++)
+    {
+        timer[i] = chip->timer;
+        eg_add[i] = chip->eg_add;
+        eg_state[i] = chip->eg_state;
+        tremolo[i] = chip->tremolo;
+        vibpos[i] = chip->vibpos;
+        OPL3_ChipTick(chip);
+    }
+
+    for (ii = 0; ii < 36; ii++)
+    {
+        opl3_slot *slot = &chip->slot[ii];
+        envelope_sinfunc sinfunc = envelope_sin[slot->reg_wf];
+        const Bit16s *mod = NULL;
+        int trem = slot->trem == &chip->tremolo;
+        int fb = slot->mod == &slot->fbmod;
+
+        if (!fb && slot->mod != &chip->zeromod)
+        {
+            mod = &out[OPL3_OutSlot(chip, slot->mod)][1];
+        }
+
+        out[ii][0] = slot->out;
+        for (i = 0; i < numsamples; i++)
+        {
+            OPL3_SlotCalcFB(slot);
+            OPL3_EnvelopeStep(slot, trem ? tremolo[i] : 0,
+                              eg_add[i], eg_state[i], timer[i]);
+            slot->pg_phase_out = OPL3_PhaseStep(slot, vibpos[i],
+                                                chip->vibshift);
+            slot->out = sinfunc(slot->pg_phase_out
+                              + (fb ? slot->fbmod : mod ? mod[i] : 0),
+                                slot->eg_out);
+            out[ii][i + 1] = slot->out;
+        }
+
+        if (ii == 13) // hh
+        {
+            chip->rm_hh_bit2 = (slot->pg_phase_out >> 2) & 1;
+            chip->rm_hh_bit3 = (slot->pg_phase_out >> 3) & 1;
+            chip->rm_hh_bit7 = (slot->pg_phase_out >> 7) & 1;
+            chip->rm_hh_bit8 = (slot->pg_phase_out >> 8) & 1;
+        }
+    }
+
+    // Noise is clocked once per slot.
+    for (i = 0; i < numsamples * 36; i++)
+    {
+        n_bit = ((chip->noise >> 14) ^ chip->noise) & 0x01;
+        chip->noise = (chip->noise >> 1) | (n_bit << 22);
+    }
+
+    for (i = 0; i < numsamples; i++)
+    {
+        mixbuff[0][i] = 0;
+        mixbuff[1][i] = 0;
+    }
+    for (ii = 0; ii < 18; ii++)
+    {
+        opl3_channel *channel = &chip->channel[ii];
+        const Bit16s *left[4], *right[4];
+
+        for (jj = 0; jj < 4; jj++)
+        {
+            int slotnum = OPL3_OutSlot(chip, channel->out[jj]);
+
+            if (slotnum < 0)
+            {
+                left[jj] = right[jj] = zeros;
+            }
+            else
+            {
+                left[jj] = &out[slotnum][slotnum < 15 ? 1 : 0];
+                right[jj] = &out[slotnum][slotnum < 33 ? 1 : 0];
+            }
+        }
+        for (i = 0; i < numsamples; i++)
+        {
+            accm[i] = left[0][i] + left[1][i] + left[2][i] + left[3][i];
+            mixbuff[0][i] += (Bit16s)(accm[i] & channel->cha);
+        }
+        for (i = 0; i < numsamples; i++)
+        {
+            accm[i] = right[0][i] + right[1][i] + right[2][i] + right[3][i];
+            mixbuff[1][i] += (Bit16s)(accm[i] & channel->chb);
+        }
+    }
+
+    // Right channel is output one sample late.
+    buf[1] = OPL3_ClipSample(chip->mixbuff[1]);
+    for (i = 0; i < numsamples; i++)
+    {
+        buf[i * 2] = OPL3_ClipSample(mixbuff[0][i]);
+        if (i + 1 < numsamples)
+        {
+            buf[i * 2 + 3] = OPL3_ClipSample(mixbuff[1][i]);
+        }
+    }
+    chip->mixbuff[0] = mixbuff[0][numsamples - 1];
+    chip->mixbuff[1] = mixbuff[1][numsamples - 1];
+
+    chip->writebuf_samplecnt += numsamples - 1;
+    OPL3_ProcessWriteBuf(chip);
+}
+
+// Generate numsamples chip samples, batching where possible.
+
+static void OPL3_GenerateNative(opl3_chip *chip, Bit16s *buf, Bit32u numsamples)
+{
+    while (numsamples > 0)
+    {
+        opl3_writebuf *next = &chip->writebuf[chip->writebuf_cur];
+        Bit32u count = numsamples;
+
+        if (count > OPL_BLOCK_SIZE)
+        {
+            count = OPL_BLOCK_SIZE;
+        }
+
+        // Stop the block at the sample after which a write is applied.
+        if ((next->reg & 0x200) && next->time < chip->writebuf_samplecnt + count)
+        {
+            count = next->time <= chip->writebuf_samplecnt ? 1
+                  : (Bit32u)(next->time - chip->writebuf_samplecnt) + 1;
+        }
+
+        if (count > 1 && OPL3_CanBatch(chip))
+        {
+            OPL3_GenerateBlock(chip, buf, count);
+        }
+        else
+        {
+            count = 1;
+            OPL3_Generate(chip, buf);
+        }
+
+        buf += count * 2;
+        numsamples -= count;
+    }
+}
+
 void OPL3_GenerateResampled(opl3_chip *chip, Bit16s *buf)
 {
     while (chip->samplecnt >= chip->rateratio)
@@ -1367,11 +1636,56 @@ void OPL3_WriteRegBuffered(opl3_chip *chip, Bit16u reg, Bit8u v)
 
 void OPL3_GenerateStream(opl3_chip *chip, Bit16s *sndptr, Bit32u numsamples)
 {
-    Bit32u i;
+    Bit16s native[OPL_NATIVE_SIZE * 2];
+    Bit32u i, count, needed, pos;
+    Bit32s samplecnt;
 
-    for(i = 0; i < numsamples; i++)
+    while (numsamples > 0)
     {
-        OPL3_GenerateResampled(chip, sndptr);
-        sndptr += 2;
+        // Find how many output samples the next batch of chip
+        // samples covers.
+        samplecnt = chip->samplecnt;
+        needed = 0;
+        for (count = 0; count < numsamples; count++)
+        {
+            Bit32u step = 0;
+
+            while (samplecnt >= chip->rateratio)
+            {
+                samplecnt -= chip->rateratio;
+                step++;
+            }
+            if (count > 0 && needed + step > OPL_NATIVE_SIZE)
+            {
+                break;
+            }
+            needed += step;
+            samplecnt += 1 << RSM_FRAC;
+        }
+
+        OPL3_GenerateNative(chip, native, needed);
+
+        // Same as OPL3_GenerateResampled, reading from native buffer.
+        pos = 0;
+        for (i = 0; i < count; i++)
+        {
+            while (chip->samplecnt >= chip->rateratio)
+            {
+                chip->oldsamples[0] = chip->samples[0];
+                chip->oldsamples[1] = chip->samples[1];
+                chip->samples[0] = native[pos * 2];
+                chip->samples[1] = native[pos * 2 + 1];
+                chip->samplecnt -= chip->rateratio;
+                pos++;
+            }
+            sndptr[0] = (Bit16s)((chip->oldsamples[0] * (chip->rateratio - chip->samplecnt)
+                                + chip->samples[0] * chip->samplecnt) / chip->rateratio);
+            sndptr[1] = (Bit16s)((chip->oldsamples[1] * (chip->rateratio - chip->samplecnt)
+                                + chip->samples[1] * chip->samplecnt) / chip->rateratio);
+            chip->samplecnt += 1 << RSM_FRAC;
+            sndptr += 2;
+        }
+
+        numsamples -= count;
     }
 }
@@ -54,6 +54,10 @@ typedef struct
 
 extern unsigned int opl_sample_rate;
 
+// Non-zero if generating output without an audio device.
+
+extern int opl_render_mode;
+
 
 #if (defined(__i386__) || defined(__x86_64__)) && defined(HAVE_IOPERM)
 extern opl_driver_t opl_linux_driver;
@@ -66,6 +70,10 @@ extern opl_driver_t opl_win32_driver;
 #endif
 extern opl_driver_t opl_sdl_driver;
 
+#ifndef DISABLE_SDL2MIXER
+void OPL_SDL_Render(int16_t *buffer, unsigned int nsamples);
+#endif
+
 
 #endif /* #ifndef OPL_INTERNAL_H */
 
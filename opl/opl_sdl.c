@@ -164,6 +164,13 @@ static void AdvanceTime(unsigned int nsamples)
 
 static void FillBuffer(uint8_t *buffer, unsigned int nsamples)
 {
+    // In render mode there is nothing to mix with.
+    if (opl_render_mode)
+    {
+        OPL3_GenerateStream(&opl_chip, (Bit16s *) buffer, nsamples);
+        return;
+    }
+
     // This seems like a reasonable assumption.  mix_buffer is
     // 1 second long, which should always be much longer than the
     // SDL mix buffer.
@@ -176,17 +183,16 @@ static void FillBuffer(uint8_t *buffer, unsigned int nsamples)
                        SDL_MIX_MAXVOLUME);
 }
 
-// Callback function to fill a new sound buffer:
+// Fill a buffer of the specified number of samples, advancing time
+// and invoking callbacks as we go.
 
-static void OPL_Mix_Callback(int chan, void *stream, int len, void *udata)
+static void GenerateSamples(Uint8 *buffer, unsigned int buffer_samples)
 {
-    unsigned int filled, buffer_samples;
-    Uint8 *buffer = (Uint8*)stream;
+    unsigned int filled;
 
     // Repeatedly call the OPL emulator update function until the buffer is
     // full.
     filled = 0;
-    buffer_samples = len / 4;
 
     while (filled < buffer_samples)
     {
@@ -229,9 +235,27 @@ static void OPL_Mix_Callback(int chan, void *stream, int len, void *udata)
     }
 }
 
+// Callback function to fill a new sound buffer:
+
+static void OPL_Mix_Callback(int chan, void *stream, int len, void *udata)
+{
+    GenerateSamples((Uint8 *) stream, len / 4);
+}
+
+// Generate samples without an audio device, time is advanced by
+// the number of samples generated.
+
+void OPL_SDL_Render(int16_t *buffer, unsigned int nsamples)
+{
+    GenerateSamples((Uint8 *) buffer, nsamples);
+}
+
 static void OPL_SDL_Shutdown(void)
 {
-    Mix_HookMusic(NULL, NULL);
+    if (!opl_render_mode)
+    {
+        Mix_HookMusic(NULL, NULL);
+    }
 
     if (sdl_was_initialized)
     {
@@ -292,7 +316,13 @@ static int OPL_SDL_Init(unsigned int port_base)
     // Check if SDL_mixer has been opened already
     // If not, we must initialize it now
 
-    if (!SDLIsInitialized())
+    if (opl_render_mode)
+    {
+        // No audio device, output goes to OPL_Render.
+
+        sdl_was_initialized = 0;
+    }
+    else if (!SDLIsInitialized())
     {
         if (SDL_Init(SDL_INIT_AUDIO) < 0)
         {
@@ -330,7 +360,16 @@ static int OPL_SDL_Init(unsigned int port_base)
 
     // Get the mixer frequency, format and number of channels.
 
-    Mix_QuerySpec(&mixing_freq, &mixing_format, &mixing_channels);
+    if (opl_render_mode)
+    {
+        mixing_freq = opl_sample_rate;
+        mixing_format = AUDIO_S16SYS;
+        mixing_channels = 2;
+    }
+    else
+    {
+        Mix_QuerySpec(&mixing_freq, &mixing_format, &mixing_channels);
+    }
 
     // Only supports AUDIO_S16SYS
 
@@ -358,7 +397,10 @@ static int OPL_SDL_Init(unsigned int port_base)
     // Set postmix that adds the OPL music. This is deliberately done
     // as a postmix and not using Mix_HookMusic() as the latter disables
     // normal SDL_mixer music mixing.
-    Mix_RegisterEffect(MIX_CHANNEL_POST, OPL_Mix_Callback, NULL, NULL);
+    if (!opl_render_mode)
+    {
+        Mix_RegisterEffect(MIX_CHANNEL_POST, OPL_Mix_Callback, NULL, NULL);
+    }
 
     return 1;
 }
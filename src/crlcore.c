@@ -14,6 +14,7 @@
 //
 
 
+#include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -25,6 +26,7 @@
 #include <windows.h>
 #endif
 
+#include "i_system.h"
 #include "i_timer.h"
 #include "z_zone.h"
 #include "v_video.h"
@@ -41,14 +43,23 @@
 jmp_buf CRLJustIncaseBuf;
 
 CRL_Data_t CRLData;
+int CRL_FrameResult;
 CRL_Widgets_t CRLWidgets;
 
-// Visplane storage.
-#define MAXCOUNTPLANES 4096
+// Visplane storage, indexed by visplane ID.
+#define MAXCOUNTPLANES 32768
 static void*   _planelist[MAXCOUNTPLANES];
-static size_t  _planesize;
 static int     _numplanes;
 
+// Plane colors of the current frame, -1 if not identified yet.
+static short   _planecolor[MAXCOUNTPLANES];
+
+// Marked span of every plane surface row, so only
+// pixels actually covered by planes are cleared and drawn.
+static short   _dirtyx1[SCREENHEIGHT];
+static short   _dirtyx2[SCREENHEIGHT];
+static int     _dirtyy1, _dirtyy2;
+
 #define DARKSHADE 8
 #define DARKMASK  7
 
@@ -109,6 +120,8 @@ static int _vptable[NUMPLANEBORDERCOLORS];
 static int _homtable[HOMCOUNT];
 int CRL_homcolor;  // Color to use
 
+static void CRL_ProfInit (void);
+
 // -----------------------------------------------------------------------------
 // CRL_Init
 // Initializes things.
@@ -120,9 +133,21 @@ void CRL_Init (void)
     int i;
 
     // Make plane surface
-    _planesize = SCREENAREA * sizeof(*CRLPlaneSurface);
-    CRLPlaneSurface = Z_Malloc(_planesize, PU_STATIC, NULL);
-    memset(CRLPlaneSurface, 0, _planesize);
+    CRLPlaneSurface = Z_Malloc(SCREENAREA * sizeof(*CRLPlaneSurface), PU_STATIC, NULL);
+    memset(CRLPlaneSurface, 0, SCREENAREA * sizeof(*CRLPlaneSurface));
+
+    for (i = 0; i < SCREENHEIGHT; i++)
+    {
+        _dirtyx1[i] = SCREENWIDTH;
+        _dirtyx2[i] = -1;
+    }
+    _dirtyy1 = SCREENHEIGHT;
+    _dirtyy2 = -1;
+
+    for (i = 0; i < MAXCOUNTPLANES; i++)
+    {
+        _planecolor[i] = -1;
+    }
 
     // [JN] Initialize HOM (RGBY) multi colors, but prevent
     // using too bright values by multiplying by 3, not by 4.
@@ -160,6 +185,8 @@ void CRL_Init (void)
     _vptable[15] = V_GetPaletteIndex(playpal, 111,   0, 107);
 
     W_ReleaseLumpName("PLAYPAL");
+
+    CRL_ProfInit();
 }
 
 
@@ -213,8 +240,8 @@ void CRL_SetStaticLimits (char *name)
 //  @param __err Frame error, 0 starts, < 0 ends OK, else renderer crashed.
 // -----------------------------------------------------------------------------
 
-uint8_t* CRLSurface = NULL;
-void**   CRLPlaneSurface = NULL;
+uint8_t*  CRLSurface = NULL;
+uint16_t* CRLPlaneSurface = NULL;
 
 static int _frame;
 static int _pulse;
@@ -224,7 +251,7 @@ static int _pulsestage;
 void CRL_ChangeFrame (int __err)
 {
     CRL_Data_t old;	
-    int fact, lim;
+    int fact, lim, y;
 
     // Clear state on zero
     if (__err == 0)
@@ -236,11 +263,25 @@ void CRL_ChangeFrame (int __err)
         memmove(&old, &CRLData, sizeof(CRLData));
         memset(&CRLData, 0, sizeof(CRLData));
 
-        // Clear old plane surface
-        memset(CRLPlaneSurface, 0, _planesize);
+        // Clear old plane surface, only where it was marked
+        for (y = _dirtyy1; y <= _dirtyy2; y++)
+        {
+            if (_dirtyx1[y] <= _dirtyx2[y])
+            {
+                memset(CRLPlaneSurface + y * SCREENWIDTH + _dirtyx1[y], 0,
+                       (_dirtyx2[y] - _dirtyx1[y] + 1) * sizeof(*CRLPlaneSurface));
+                _dirtyx1[y] = SCREENWIDTH;
+                _dirtyx2[y] = -1;
+            }
+        }
+        _dirtyy1 = SCREENHEIGHT;
+        _dirtyy2 = -1;
 
-        // Plane set
-        memset(_planelist, 0, sizeof(_planelist));
+        // Plane set, forget colors of old planes
+        for (y = 0; y < _numplanes; y++)
+        {
+            _planecolor[y] = -1;
+        }
         _numplanes = 0;
 
         // Change pulse
@@ -283,20 +324,79 @@ void CRL_ChangeFrame (int __err)
             }
         }
     }
+    else
+    {
+        // Remember how the frame ended
+        CRL_FrameResult = __err;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// CRL_MarkColumn
+//  Mark column of pixels that was drawn by a visplane.
+//  @param __id Visplane ID.
+//  @param __drawp Where the top pixel was drawn.
+//  @param __count Number of pixels.
+// -----------------------------------------------------------------------------
+
+void CRL_MarkColumn (int __id, void* __drawp, int __count)
+{
+    const int ofs = (uint8_t*)__drawp - CRLSurface;
+    const int x = ofs % SCREENWIDTH;
+    int y = ofs / SCREENWIDTH;
+    uint16_t *dest = CRLPlaneSurface + ofs;
+
+    // Nobody will look at it
+    if (crl_visplanes_drawing == 0)
+    {
+        return;
+    }
+
+    _dirtyy1 = MIN(_dirtyy1, y);
+    _dirtyy2 = MAX(_dirtyy2, y + __count - 1);
+
+    for ( ; __count > 0; __count--, y++, dest += SCREENWIDTH)
+    {
+        *dest = __id + 1;
+
+        if (x < _dirtyx1[y])
+            _dirtyx1[y] = x;
+        if (x > _dirtyx2[y])
+            _dirtyx2[y] = x;
+    }
 }
 
 // -----------------------------------------------------------------------------
-// CRL_MarkPixelP
-//  Mark pixel that was drawn.
-//  @param __surface Target surface that gets it.
-//  @param __what What was drawn here.
-//  @param __drawp Where it was drawn.
+// CRL_MarkSpan
+//  Mark row of pixels that was drawn by a visplane.
+//  @param __id Visplane ID.
+//  @param __drawp Where the leftmost pixel was drawn.
+//  @param __count Number of pixels.
 // -----------------------------------------------------------------------------
 
-void CRL_MarkPixelP (void** __surface, void* __what, void* __drawp)
+void CRL_MarkSpan (int __id, void* __drawp, int __count)
 {
-    // Set surface to what
-    __surface[(uintptr_t)__drawp - (uintptr_t)CRLSurface] = __what;
+    const int ofs = (uint8_t*)__drawp - CRLSurface;
+    const int x = ofs % SCREENWIDTH;
+    const int y = ofs / SCREENWIDTH;
+    uint16_t *dest = CRLPlaneSurface + ofs;
+    int i;
+
+    // Nobody will look at it
+    if (crl_visplanes_drawing == 0)
+    {
+        return;
+    }
+
+    for (i = 0; i < __count; i++)
+    {
+        dest[i] = __id + 1;
+    }
+
+    _dirtyx1[y] = MIN(_dirtyx1[y], x);
+    _dirtyx2[y] = MAX(_dirtyx2[y], x + __count - 1);
+    _dirtyy1 = MIN(_dirtyy1, y);
+    _dirtyy2 = MAX(_dirtyy2, y);
 }
 
 // -----------------------------------------------------------------------------
@@ -335,6 +435,26 @@ static int CRL_ColorizeThisPlane (CRLPlaneData_t *__pl)
     return _vptable[id % NUMPLANEBORDERCOLORS];
 }
 
+// -----------------------------------------------------------------------------
+// CRL_PlaneColor
+//  Identifies and colorizes plane only once per frame.
+//  @param __id Visplane ID.
+//  @return Plane color
+// -----------------------------------------------------------------------------
+
+static int CRL_PlaneColor (int __id)
+{
+    CRLPlaneData_t pd;
+
+    if (_planecolor[__id] < 0)
+    {
+        GAME_IdentifyPlane(_planelist[__id], &pd);
+        _planecolor[__id] = CRL_ColorizeThisPlane(&pd);
+    }
+
+    return _planecolor[__id];
+}
+
 // -----------------------------------------------------------------------------
 // CRL_DrawVisPlanes
 //  Draw visplanes (underlay or overlay).
@@ -342,9 +462,8 @@ static int CRL_ColorizeThisPlane (CRLPlaneData_t *__pl)
 
 void CRL_DrawVisPlanes (int __over)
 {
-    int isover, x, y, i, isbord, c;
-    void* is;
-    CRLPlaneData_t pd;
+    int isover, x, y, i, isbord;
+    int is;
 
     // Get visplane drawing mode
 
@@ -364,40 +483,30 @@ void CRL_DrawVisPlanes (int __over)
     // Border colors
     isbord = (crl_visplanes_drawing == 3 || crl_visplanes_drawing == 4);
 
-    // Go through all pixels and draw visplane if one is there
-    memset(&pd, 0, sizeof(pd));
-    for (i = 0, x = 0, y = 0; i < SCREENAREA; i++, x++)
+    // Go through marked pixels and draw visplane if one is there,
+    // everything outside of marked spans is known to be empty
+    for (y = _dirtyy1; y <= _dirtyy2; y++)
     {
-        // Increase y
-        if (x >= SCREENWIDTH)
+        for (x = _dirtyx1[y], i = y * SCREENWIDTH + x; x <= _dirtyx2[y]; x++, i++)
         {
-            x = 0;
-            y++;
-        }
-
-        // Get plane drawn here
-        if (!(is = CRLPlaneSurface[i]))
-        {
-            continue;
-        }
-
-        // Border check
-        if (isbord)
-            if (x > 0 && x < SCREENWIDTH - 1 && y > 0 && y < SCREENHEIGHT - 1
-                && (is == CRLPlaneSurface[i - 1] &&
-                is == CRLPlaneSurface[i + 1] &&
-                is == CRLPlaneSurface[i - SCREENWIDTH] &&
-                is == CRLPlaneSurface[i + SCREENWIDTH]))
-            continue;
-
-        // Get plane identity
-        GAME_IdentifyPlane(is, &pd);
+            // Get plane drawn here
+            if (!(is = CRLPlaneSurface[i]))
+            {
+                continue;
+            }
 
-        // Color the plane
-        c = CRL_ColorizeThisPlane(&pd);
+            // Border check
+            if (isbord)
+                if (x > 0 && x < SCREENWIDTH - 1 && y > 0 && y < SCREENHEIGHT - 1
+                    && (is == CRLPlaneSurface[i - 1] &&
+                    is == CRLPlaneSurface[i + 1] &&
+                    is == CRLPlaneSurface[i - SCREENWIDTH] &&
+                    is == CRLPlaneSurface[i + SCREENWIDTH]))
+                continue;
 
-        // Draw plane colors
-        CRLSurface[i] = c;
+            // Draw plane colors
+            CRLSurface[i] = CRL_PlaneColor(is - 1);
+        }
     }
 }
 
@@ -422,9 +531,10 @@ void CRL_CountPlane (void* __key, int __chorf, int __id)
     }
 
     // Add to global list
-    if (_numplanes < MAXCOUNTPLANES)
+    if (__id >= 0 && __id < MAXCOUNTPLANES)
     {
-        _planelist[_numplanes++] = __key;
+        _planelist[__id] = __key;
+        _numplanes = MAX(_numplanes, __id + 1);
     }
 }
 
@@ -601,6 +711,500 @@ void CRL_ImpulseCameraVert (boolean direction, fixed_t intensity)
 }
 
 
+// =============================================================================
+//
+//                              Render profiler
+//
+// =============================================================================
+
+const char *CRL_ProfNames[CRL_NUMPROFS] =
+{
+    "SETUP", "BSP", "PLANES", "VISPL", "MASKED", "AMAP", "HUD", "BLIT"
+};
+
+// Average time of each phase (in microseconds) over the last second.
+int CRL_ProfTimes[CRL_NUMPROFS];
+
+static uint64_t _profstart[CRL_NUMPROFS];
+static uint64_t _profframe[CRL_NUMPROFS];
+static uint64_t _profsum[CRL_NUMPROFS];
+static uint64_t _proflast;
+static int      _profframes;
+
+// Per-frame CSV trace.
+static FILE *_proftrace;
+static int   _proftraceframe;
+
+// Timedemo report is collected from profiler data.
+static boolean _benchactive;
+static void CRL_BenchFrame (const uint64_t now);
+
+// Timing is only worth its cost while someone looks at it.
+#define CRL_Profiling() (crl_showfps == 2 || _proftrace != NULL || _benchactive)
+
+static void CRL_ProfClose (void)
+{
+    if (_proftrace != NULL)
+    {
+        fclose(_proftrace);
+        _proftrace = NULL;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// CRL_ProfInit
+//  Opens CSV trace file if one was requested.
+// -----------------------------------------------------------------------------
+
+static void CRL_ProfInit (void)
+{
+    int i, p;
+
+    //!
+    // @arg <file>
+    // @category obscure
+    //
+    // Write time spent in every rendering phase of every
+    // frame (in microseconds) to CSV file.
+    //
+
+    p = M_CheckParmWithArgs("-proftrace", 1);
+
+    if (!p)
+    {
+        return;
+    }
+
+    _proftrace = M_fopen(myargv[p+1], "w");
+
+    if (_proftrace == NULL)
+    {
+        printf("CRL_ProfInit: unable to open %s\n", myargv[p+1]);
+        return;
+    }
+
+    fprintf(_proftrace, "frame");
+    for (i = 0; i < CRL_NUMPROFS; i++)
+    {
+        fprintf(_proftrace, ",%s", CRL_ProfNames[i]);
+    }
+    fprintf(_proftrace, "\n");
+
+    I_AtExit(CRL_ProfClose, true);
+}
+
+// -----------------------------------------------------------------------------
+// CRL_ProfStart, CRL_ProfStop
+//  Start and stop timing of given phase. A phase may be
+//  timed several times per frame, times are summed up.
+//  @param __phase One of CRL_PROF_*.
+// -----------------------------------------------------------------------------
+
+void CRL_ProfStart (int __phase)
+{
+    if (CRL_Profiling())
+    {
+        _profstart[__phase] = I_GetTimeUS();
+    }
+}
+
+void CRL_ProfStop (int __phase)
+{
+    if (CRL_Profiling() && _profstart[__phase])
+    {
+        _profframe[__phase] += I_GetTimeUS() - _profstart[__phase];
+        _profstart[__phase] = 0;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// CRL_ProfFrame
+//  Ends profiled frame, called right after I_FinishUpdate.
+// -----------------------------------------------------------------------------
+
+void CRL_ProfFrame (void)
+{
+    const uint64_t now = I_GetTimeUS();
+    int i;
+
+    if (!CRL_Profiling())
+    {
+        return;
+    }
+
+    if (_proftrace != NULL)
+    {
+        fprintf(_proftrace, "%d", _proftraceframe++);
+        for (i = 0; i < CRL_NUMPROFS; i++)
+        {
+            fprintf(_proftrace, ",%d", (int) _profframe[i]);
+        }
+        fprintf(_proftrace, "\n");
+    }
+
+    if (_benchactive)
+    {
+        CRL_BenchFrame(now);
+    }
+
+    for (i = 0; i < CRL_NUMPROFS; i++)
+    {
+        _profsum[i] += _profframe[i];
+        _profframe[i] = 0;
+    }
+    _profframes++;
+
+    // Update widget values once per second, same as FPS counter.
+    if (now - _proflast >= 1000000)
+    {
+        for (i = 0; i < CRL_NUMPROFS; i++)
+        {
+            CRL_ProfTimes[i] = (int)(_profsum[i] / _profframes);
+            _profsum[i] = 0;
+        }
+        _profframes = 0;
+        _proflast = now;
+    }
+}
+
+
+// =============================================================================
+//
+//                              Timedemo report
+//
+// =============================================================================
+
+typedef struct
+{
+    uint32_t frame;    // Time since previous frame.
+    uint32_t render;   // All the phases but present.
+    uint32_t present;  // I_FinishUpdate.
+} benchframe_t;
+
+typedef struct
+{
+    char       name[9];
+    int        starttic;
+    int        firstframe;
+    CRL_Data_t peak;   // Highest render counters.
+} benchmap_t;
+
+typedef struct
+{
+    uint32_t min, avg, p50, p95, p99, max;
+} benchstats_t;
+
+// Upper bounds of frame time histogram buckets (in milliseconds),
+// last bucket collects everything above.
+static const int _benchbuckets[] = { 1, 2, 4, 8, 16, 33, 50, 100 };
+#define NUMBENCHBUCKETS ((int) arrlen(_benchbuckets) + 1)
+
+static char         *_benchfile;
+static benchframe_t *_benchframes;
+static int           _benchnumframes;
+static int           _benchmaxframes;
+static benchmap_t   *_benchmaps;
+static int           _benchnummaps;
+static uint64_t      _benchlast;
+static uint32_t     *_benchsort;
+
+// -----------------------------------------------------------------------------
+// CRL_BenchStart
+//  Starts collecting frame times for -timedemo report.
+//  @param __demo Demo file name, report is written next to it.
+// -----------------------------------------------------------------------------
+
+void CRL_BenchStart (const char *__demo)
+{
+    char *name = M_StringDuplicate(__demo);
+    char *uc_name = M_StringDuplicate(__demo);
+
+    M_ForceUppercase(uc_name);
+
+    if (M_StringEndsWith(uc_name, ".LMP"))
+    {
+        name[strlen(name) - 4] = '\0';
+    }
+
+    _benchfile = M_StringJoin(name, ".json", NULL);
+    _benchactive = true;
+
+    free(uc_name);
+    free(name);
+}
+
+// -----------------------------------------------------------------------------
+// CRL_BenchMap
+//  Starts new per-map section of timedemo report.
+//  @param __name Map name.
+//  @param __tic Game tic of the level start.
+// -----------------------------------------------------------------------------
+
+void CRL_BenchMap (const char *__name, const int __tic)
+{
+    benchmap_t *map;
+
+    if (!_benchactive)
+    {
+        return;
+    }
+
+    _benchmaps = I_Realloc(_benchmaps, (_benchnummaps + 1) * sizeof(*_benchmaps));
+    map = &_benchmaps[_benchnummaps++];
+
+    memset(map, 0, sizeof(*map));
+    M_StringCopy(map->name, __name, sizeof(map->name));
+    map->starttic = __tic;
+    map->firstframe = _benchnumframes;
+
+    // Do not count level loading as frame time.
+    _benchlast = I_GetTimeUS();
+}
+
+// -----------------------------------------------------------------------------
+// CRL_BenchFrame
+//  Stores times of just finished frame.
+// -----------------------------------------------------------------------------
+
+static void CRL_BenchFrame (const uint64_t now)
+{
+    benchframe_t *frame;
+    benchmap_t *map;
+    int i;
+
+    if (_benchnummaps == 0)
+    {
+        return;
+    }
+
+    if (_benchnumframes == _benchmaxframes)
+    {
+        _benchmaxframes = _benchmaxframes ? _benchmaxframes * 2 : 4096;
+        _benchframes = I_Realloc(_benchframes,
+                                 _benchmaxframes * sizeof(*_benchframes));
+    }
+
+    frame = &_benchframes[_benchnumframes++];
+    frame->frame = (uint32_t)(now - _benchlast);
+    frame->render = 0;
+    frame->present = (uint32_t)_profframe[CRL_PROF_PRESENT];
+    for (i = 0; i < CRL_PROF_PRESENT; i++)
+    {
+        frame->render += (uint32_t)_profframe[i];
+    }
+    _benchlast = now;
+
+    map = &_benchmaps[_benchnummaps - 1];
+    map->peak.numsprites = MAX(map->peak.numsprites, CRLData.numsprites);
+    map->peak.numsegs = MAX(map->peak.numsegs, CRLData.numsegs);
+    map->peak.numsolidsegs = MAX(map->peak.numsolidsegs, CRLData.numsolidsegs);
+    map->peak.numcheckplanes = MAX(map->peak.numcheckplanes, CRLData.numcheckplanes);
+    map->peak.numfindplanes = MAX(map->peak.numfindplanes, CRLData.numfindplanes);
+    map->peak.numopenings = MAX(map->peak.numopenings, CRLData.numopenings);
+}
+
+static int CRL_BenchCompare (const void *a, const void *b)
+{
+    const uint32_t x = *(const uint32_t *) a;
+    const uint32_t y = *(const uint32_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+// -----------------------------------------------------------------------------
+// CRL_BenchStats
+//  Calculates min/avg/percentiles/max of one field of given frames.
+// -----------------------------------------------------------------------------
+
+static void CRL_BenchStats (int __first, int __count, size_t __field,
+                            benchstats_t *__st)
+{
+    uint64_t sum = 0;
+    int i;
+
+    memset(__st, 0, sizeof(*__st));
+
+    if (__count <= 0)
+    {
+        return;
+    }
+
+    for (i = 0; i < __count; i++)
+    {
+        const byte *frame = (const byte *) &_benchframes[__first + i];
+
+        _benchsort[i] = *(const uint32_t *) (frame + __field);
+        sum += _benchsort[i];
+    }
+
+    qsort(_benchsort, __count, sizeof(*_benchsort), CRL_BenchCompare);
+
+    __st->min = _benchsort[0];
+    __st->avg = (uint32_t)(sum / __count);
+    __st->p50 = _benchsort[(__count - 1) * 50 / 100];
+    __st->p95 = _benchsort[(__count - 1) * 95 / 100];
+    __st->p99 = _benchsort[(__count - 1) * 99 / 100];
+    __st->max = _benchsort[__count - 1];
+}
+
+static void CRL_BenchPrintStats (const char *__name, const benchstats_t *__st)
+{
+    printf("  %-8s %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f\n", __name,
+           __st->min / 1000.0, __st->avg / 1000.0, __st->p50 / 1000.0,
+           __st->p95 / 1000.0, __st->p99 / 1000.0, __st->max / 1000.0);
+}
+
+static void CRL_BenchWriteStats (FILE *__f, const char *__name,
+                                 const benchstats_t *__st, const char *__end)
+{
+    fprintf(__f, "\"%s\": { \"min\": %u, \"avg\": %u, \"p50\": %u, "
+                 "\"p95\": %u, \"p99\": %u, \"max\": %u }%s",
+            __name, __st->min, __st->avg, __st->p50,
+            __st->p95, __st->p99, __st->max, __end);
+}
+
+// -----------------------------------------------------------------------------
+// CRL_BenchReport
+//  Prints timedemo report and writes it as JSON file.
+//  @param __gametics Total game tics of the demo.
+//  @param __realtics Real tics spent to play it.
+// -----------------------------------------------------------------------------
+
+void CRL_BenchReport (const int __gametics, const int __realtics)
+{
+    const size_t fields[3] = {
+        offsetof(benchframe_t, frame),
+        offsetof(benchframe_t, render),
+        offsetof(benchframe_t, present),
+    };
+    static const char *names[3] = { "frame", "render", "present" };
+    int histogram[NUMBENCHBUCKETS];
+    benchstats_t st[3];
+    FILE *f;
+    int i, j;
+
+    if (!_benchactive)
+    {
+        return;
+    }
+
+    _benchactive = false;
+    _benchsort = malloc(MAX(_benchnumframes, 1) * sizeof(*_benchsort));
+
+    memset(histogram, 0, sizeof(histogram));
+    for (i = 0; i < _benchnumframes; i++)
+    {
+        const int ms = _benchframes[i].frame / 1000;
+
+        for (j = 0; j < NUMBENCHBUCKETS - 1 && ms >= _benchbuckets[j]; j++);
+        histogram[j]++;
+    }
+
+    printf("\nTimedemo report: %d frames in %d gametics, %d realtics\n",
+           _benchnumframes, __gametics, __realtics);
+    printf("  %-8s %8s %8s %8s %8s %8s %8s\n",
+           "(ms)", "min", "avg", "p50", "p95", "p99", "max");
+    for (i = 0; i < 3; i++)
+    {
+        CRL_BenchStats(0, _benchnumframes, fields[i], &st[i]);
+        CRL_BenchPrintStats(names[i], &st[i]);
+    }
+
+    printf("\n  Frame time histogram:\n");
+    for (j = 0; j < NUMBENCHBUCKETS; j++)
+    {
+        if (j < NUMBENCHBUCKETS - 1)
+            printf("  < %3d ms %8d\n", _benchbuckets[j], histogram[j]);
+        else
+            printf("  >=%3d ms %8d\n", _benchbuckets[j - 1], histogram[j]);
+    }
+
+    f = M_fopen(_benchfile, "w");
+
+    if (f == NULL)
+    {
+        printf("\nCRL_BenchReport: unable to write %s\n", _benchfile);
+    }
+    else
+    {
+        fprintf(f, "{\n  \"gametics\": %d,\n  \"realtics\": %d,\n"
+                   "  \"frames\": %d,\n", __gametics, __realtics,
+                   _benchnumframes);
+        for (i = 0; i < 3; i++)
+        {
+            fprintf(f, "  ");
+            CRL_BenchWriteStats(f, names[i], &st[i], ",\n");
+        }
+
+        fprintf(f, "  \"histogram\": [\n");
+        for (j = 0; j < NUMBENCHBUCKETS; j++)
+        {
+            if (j < NUMBENCHBUCKETS - 1)
+                fprintf(f, "    { \"below_ms\": %d, ", _benchbuckets[j]);
+            else
+                fprintf(f, "    { \"below_ms\": null, ");
+            fprintf(f, "\"count\": %d }%s\n", histogram[j],
+                    j < NUMBENCHBUCKETS - 1 ? "," : "");
+        }
+        fprintf(f, "  ],\n  \"maps\": [\n");
+    }
+
+    printf("\n  %-8s %7s %7s %8s %8s %8s %7s %7s %7s %7s\n", "Map", "tics",
+           "frames", "avg", "p99", "max", "sprites", "segs", "planes", "opens");
+
+    for (i = 0; i < _benchnummaps; i++)
+    {
+        const benchmap_t *map = &_benchmaps[i];
+        const int last = i + 1 < _benchnummaps ? _benchmaps[i + 1].firstframe
+                                               : _benchnumframes;
+        const int endtic = i + 1 < _benchnummaps ? _benchmaps[i + 1].starttic
+                                                 : __gametics;
+
+        for (j = 0; j < 3; j++)
+        {
+            CRL_BenchStats(map->firstframe, last - map->firstframe,
+                           fields[j], &st[j]);
+        }
+
+        printf("  %-8s %7d %7d %8.2f %8.2f %8.2f %7d %7d %7d %7d\n",
+               map->name, endtic - map->starttic, last - map->firstframe,
+               st[0].avg / 1000.0, st[0].p99 / 1000.0, st[0].max / 1000.0,
+               map->peak.numsprites, map->peak.numsegs,
+               map->peak.numfindplanes + map->peak.numcheckplanes,
+               map->peak.numopenings);
+
+        if (f != NULL)
+        {
+            fprintf(f, "    {\n      \"map\": \"%s\",\n"
+                       "      \"gametics\": %d,\n      \"frames\": %d,\n",
+                    map->name, endtic - map->starttic, last - map->firstframe);
+            for (j = 0; j < 3; j++)
+            {
+                fprintf(f, "      ");
+                CRL_BenchWriteStats(f, names[j], &st[j], ",\n");
+            }
+            fprintf(f, "      \"peak\": { \"sprites\": %d, \"segs\": %d, "
+                       "\"solidsegs\": %d, \"checkplanes\": %d, "
+                       "\"findplanes\": %d, \"openings\": %d }\n    }%s\n",
+                    map->peak.numsprites, map->peak.numsegs,
+                    map->peak.numsolidsegs, map->peak.numcheckplanes,
+                    map->peak.numfindplanes, map->peak.numopenings,
+                    i + 1 < _benchnummaps ? "," : "");
+        }
+    }
+
+    if (f != NULL)
+    {
+        fprintf(f, "  ]\n}\n");
+        fclose(f);
+        printf("\n  Report written to %s\n", _benchfile);
+    }
+
+    free(_benchsort);
+    _benchsort = NULL;
+}
+
+
 // =============================================================================
 //
 //                  Critical message, console output coloring
@@ -95,11 +95,14 @@ extern jmp_buf CRLJustIncaseBuf;
 // Data info.
 extern CRL_Data_t CRLData;
 
+// Result of the last finished frame (< 0 OK, else CRL_JUMP_* code).
+extern int CRL_FrameResult;
+
 // Screen surface.
 extern uint8_t* CRLSurface;
 
-// Visplane surface.
-extern void** CRLPlaneSurface;
+// Visplane surface, visplane ID + 1 per pixel.
+extern uint16_t* CRLPlaneSurface;
 
 // [JN] Widgets data. 
 typedef struct CRL_Widgets_s
@@ -144,7 +147,8 @@ extern fixed_t fractionaltic;
 
 extern void CRL_Init (void);
 extern void CRL_ChangeFrame (int __err);
-extern void CRL_MarkPixelP (void** __surface, void* __what, void* __drawp);
+extern void CRL_MarkColumn (int __id, void* __drawp, int __count);
+extern void CRL_MarkSpan (int __id, void* __drawp, int __count);
 extern void CRL_DrawVisPlanes (int __over);
 extern void CRL_CountPlane (void* __key, int __chorf, int __id);
 extern void CRL_GetHOMMultiColor (void);
@@ -212,6 +216,38 @@ extern int  CRL_buttons_counter;
 extern void CRL_DrawFPS (void);
 extern int  CRL_fps;
 
+//
+// Render profiler
+//
+
+enum
+{
+    CRL_PROF_SETUP,      // R_SetupFrame
+    CRL_PROF_BSP,        // R_RenderBSPNode
+    CRL_PROF_PLANES,     // R_DrawPlanes
+    CRL_PROF_VISPLANES,  // CRL_DrawVisPlanes
+    CRL_PROF_MASKED,     // R_DrawMasked
+    CRL_PROF_AUTOMAP,    // AM_Drawer
+    CRL_PROF_HUD,        // Widgets, status bar, messages and menu
+    CRL_PROF_PRESENT,    // I_FinishUpdate
+    CRL_NUMPROFS
+};
+
+extern const char *CRL_ProfNames[CRL_NUMPROFS];
+extern int  CRL_ProfTimes[CRL_NUMPROFS];
+
+extern void CRL_ProfStart (int __phase);
+extern void CRL_ProfStop (int __phase);
+extern void CRL_ProfFrame (void);
+
+//
+// Timedemo report
+//
+
+extern void CRL_BenchStart (const char *__demo);
+extern void CRL_BenchMap (const char *__name, const int __tic);
+extern void CRL_BenchReport (const int __gametics, const int __realtics);
+
 extern boolean CRL_vilebomb;
 extern boolean CRL_aircontrol;
 
@@ -42,6 +42,7 @@ int crl_screen_size = 10;
 int crl_screenwipe = 0;
 int crl_text_shadows = 0;
 int crl_colorblind = 0;
+int crl_plane_threads = 0;
 
 // Game modes
 int crl_spectating = 0;
@@ -76,6 +77,7 @@ int crl_colored_stbar = 0;
 int crl_revealed_secrets = 0;
 int crl_restore_targets = 0;
 int crl_death_use_action = 0;
+int crl_rewind_interval = 0;
 
 // Demos
 int crl_demo_timer = 0;
@@ -115,6 +117,7 @@ void CRL_BindVariables (void)
     M_BindIntVariable("crl_screenwipe",                 &crl_screenwipe);
     M_BindIntVariable("crl_text_shadows",               &crl_text_shadows);
     M_BindIntVariable("crl_colorblind",                 &crl_colorblind);
+    M_BindIntVariable("crl_plane_threads",              &crl_plane_threads);
 
     // Widgets
     M_BindIntVariable("crl_extended_hud",               &crl_extended_hud);
@@ -145,6 +148,7 @@ void CRL_BindVariables (void)
     M_BindIntVariable("crl_revealed_secrets",           &crl_revealed_secrets);
     M_BindIntVariable("crl_restore_targets",            &crl_restore_targets);
     M_BindIntVariable("crl_death_use_action",           &crl_death_use_action);
+    M_BindIntVariable("crl_rewind_interval",            &crl_rewind_interval);
 
     // Demos
     M_BindIntVariable("crl_demo_timer",                 &crl_demo_timer);
@@ -42,6 +42,7 @@ extern int crl_screen_size;
 extern int crl_screenwipe;
 extern int crl_text_shadows;
 extern int crl_colorblind;
+extern int crl_plane_threads;
 
 // Game modes
 extern int crl_spectating;
@@ -76,6 +77,7 @@ extern int crl_colored_stbar;
 extern int crl_revealed_secrets;
 extern int crl_restore_targets;
 extern int crl_death_use_action;
+extern int crl_rewind_interval;
 
 // Demos
 extern int crl_demo_timer;
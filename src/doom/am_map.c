@@ -1997,6 +1997,14 @@ static void AM_MapNameDrawer (void)
     // [JN] Apply translucency while Save/Load menu is active.
     dp_translucent = savemenuactive;
     M_WriteText(0, 160, str, NULL);
+
+    // [JN] CRL - Sound propagation mode: cost of the last noise alert.
+    if (crl_automap_sndprop)
+    {
+        sprintf(str, "SND %d SECTORS, %d PORTALS", soundstats[0], soundstats[1]);
+        M_WriteText(0, 151, str, NULL);
+    }
+
     dp_translucent = false;
 }
 
@@ -599,6 +599,29 @@ void CRL_DrawFPS (void)
                                  - M_StringWidth(fps_str), yy, fps, cr[CR_GRAY]);
 
     M_WriteText(SCREENWIDTH - 7 - M_StringWidth(fps_str), yy, "FPS", cr[CR_GRAY]);
+
+    // [JN] Render profiler: average time of every phase in milliseconds.
+    if (crl_showfps == 2)
+    {
+        char str[32];
+        int  i;
+
+        for (i = 0 ; i < CRL_NUMPROFS ; i++)
+        {
+            yy += 9;
+            M_snprintf(str, sizeof(str), "%s %d.%02d", CRL_ProfNames[i],
+                       CRL_ProfTimes[i] / 1000, CRL_ProfTimes[i] % 1000 / 10);
+            M_WriteText(SCREENWIDTH - 7 - M_StringWidth(str), yy, str,
+                        cr[CR_GRAY]);
+        }
+
+        // [JN] Sight checks of the last tic: REJECT hits, BSP walks, nodes.
+        yy += 9;
+        M_snprintf(str, sizeof(str), "SGT %d/%d/%d",
+                   sightstats[0], sightstats[1], sightstats[2]);
+        M_WriteText(SCREENWIDTH - 7 - M_StringWidth(str), yy, str,
+                    cr[CR_GRAY]);
+    }
 }
 
 // =============================================================================
@@ -0,0 +1,214 @@
+//
+// Copyright(C) 2018-2024 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//  Headless music renderer. Plays a music lump through OPL emulation
+//  without an audio device, as fast as possible, and writes it to
+//  a WAV file while measuring emulation throughput.
+//
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "i_sound.h"
+#include "i_swap.h"
+#include "i_system.h"
+#include "i_timer.h"
+#include "m_argv.h"
+#include "m_misc.h"
+#include "s_sound.h"
+#include "w_wad.h"
+#include "z_zone.h"
+
+#include "crlcore.h"
+#include "crlmusic.h"
+
+
+#define RENDERCHUNK 4096  // Samples generated per call.
+
+// -----------------------------------------------------------------------------
+// RenderWriteLE
+//  Writes little-endian value of given size in bytes.
+// -----------------------------------------------------------------------------
+
+static void RenderWriteLE (FILE *f, unsigned int value, int size)
+{
+    int i;
+
+    for (i = 0 ; i < size ; i++)
+    {
+        fputc((value >> (i * 8)) & 0xff, f);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// RenderWriteHeader
+//  Writes 44-byte header of 16-bit stereo PCM WAV file.
+// -----------------------------------------------------------------------------
+
+static void RenderWriteHeader (FILE *f, int samplerate, unsigned int numsamples)
+{
+    const unsigned int datalen = numsamples * 4;
+
+    fwrite("RIFF", 1, 4, f);
+    RenderWriteLE(f, datalen + 36, 4);
+    fwrite("WAVEfmt ", 1, 8, f);
+    RenderWriteLE(f, 16, 4);              // Format chunk length
+    RenderWriteLE(f, 1, 2);               // PCM
+    RenderWriteLE(f, 2, 2);               // Channels
+    RenderWriteLE(f, samplerate, 4);
+    RenderWriteLE(f, samplerate * 4, 4);  // Bytes per second
+    RenderWriteLE(f, 4, 2);               // Bytes per sample frame
+    RenderWriteLE(f, 16, 2);              // Bits per sample
+    fwrite("data", 1, 4, f);
+    RenderWriteLE(f, datalen, 4);
+}
+
+// -----------------------------------------------------------------------------
+// RenderFindLump
+//  Finds music lump by name, "D_" prefix may be omitted.
+// -----------------------------------------------------------------------------
+
+static int RenderFindLump (const char *name)
+{
+    char lumpname[9];
+    int lump = W_CheckNumForName(name);
+
+    if (lump < 0)
+    {
+        M_snprintf(lumpname, sizeof(lumpname), "d_%s", name);
+        lump = W_CheckNumForName(lumpname);
+    }
+
+    return lump;
+}
+
+// -----------------------------------------------------------------------------
+// CRL_RenderMusic
+//  [JN] Renders given music lump without a window and an audio device,
+//  using the same OPL callbacks as in game, but clocked by generated
+//  samples instead of the SDL mixer. Writes it to a WAV file and
+//  reports samples per second. Never returns.
+// -----------------------------------------------------------------------------
+
+void CRL_RenderMusic (const char *name, const char *filename)
+{
+    int16_t *buffer;
+    void *handle;
+    FILE *f;
+    boolean playing = true;
+    unsigned int numsamples = 0, maxsamples, tailsamples;
+    uint64_t rendertime = 0, starttime;
+    int lump, samplerate;
+    int p;
+
+    lump = RenderFindLump(name);
+
+    if (lump < 0)
+    {
+        I_Error("CRL_RenderMusic: music lump %s not found", name);
+    }
+
+    //!
+    // @arg <seconds>
+    // @category obscure
+    //
+    // Maximum length of music rendered by -rendermusic (default 600).
+    //
+
+    p = M_CheckParmWithArgs("-renderlength", 1);
+    samplerate = snd_samplerate;
+    maxsamples = (p ? BETWEEN(1, 3600, atoi(myargv[p+1])) : 600) * samplerate;
+
+    // Let notes ring out for a second after the song ends.
+    tailsamples = samplerate;
+
+    // Called before I_InitSound, so no audio device has been opened.
+    // The song goes through OPL emulation only.
+    S_SetOPLDriverVer();
+    I_OPL_SetRenderMode(true);
+
+    if (!music_opl_module.Init())
+    {
+        I_Error("CRL_RenderMusic: failed to initialize OPL emulation");
+    }
+
+    music_opl_module.SetMusicVolume(127);
+    handle = music_opl_module.RegisterSong(W_CacheLumpNum(lump, PU_STATIC),
+                                           W_LumpLength(lump));
+
+    if (handle == NULL)
+    {
+        I_Error("CRL_RenderMusic: %s is not a MUS or MIDI lump", name);
+    }
+
+    f = M_fopen(filename, "wb");
+
+    if (f == NULL)
+    {
+        I_Error("CRL_RenderMusic: unable to write %s", filename);
+    }
+
+    printf("CRL_RenderMusic: %s, %d Hz.\n", lumpinfo[lump]->name, samplerate);
+
+    // Header is written again once the length is known.
+    RenderWriteHeader(f, samplerate, 0);
+    buffer = malloc(RENDERCHUNK * 4);
+
+    music_opl_module.PlaySong(handle, false);
+
+    while (numsamples < maxsamples && (playing || tailsamples > 0))
+    {
+        const unsigned int count = MIN(RENDERCHUNK, maxsamples - numsamples);
+        unsigned int i;
+
+        if (!playing)
+        {
+            tailsamples -= MIN(tailsamples, count);
+        }
+
+        starttime = I_GetTimeUS();
+        playing = I_OPL_RenderMusic(buffer, count);
+        rendertime += I_GetTimeUS() - starttime;
+
+        for (i = 0 ; i < count * 2 ; i++)
+        {
+            buffer[i] = SHORT(buffer[i]);
+        }
+
+        fwrite(buffer, 4, count, f);
+        numsamples += count;
+    }
+
+    fseek(f, 0, SEEK_SET);
+    RenderWriteHeader(f, samplerate, numsamples);
+    fclose(f);
+    free(buffer);
+
+    music_opl_module.StopSong();
+    music_opl_module.UnRegisterSong(handle);
+    music_opl_module.Shutdown();
+
+    // Time spent writing the file is not counted.
+    rendertime = MAX(1, rendertime);
+    printf("CRL_RenderMusic: %u samples (%.3f s) in %.3f s, "
+           "%.0f samples per second, %.1fx real time.\n", numsamples,
+           (double) numsamples / samplerate, rendertime / 1000000.0,
+           numsamples * 1000000.0 / rendertime,
+           numsamples * 1000000.0 / samplerate / rendertime);
+    printf("CRL_RenderMusic: wrote %s\n", filename);
+
+    I_Quit();
+}
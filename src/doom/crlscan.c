@@ -0,0 +1,515 @@
+//
+// Copyright(C) 2018-2024 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//  Headless render limits scanner. Sweeps a grid of viewpoints and
+//  view angles over a whole map through R_RenderPlayerView and reports
+//  the spots which are closest to (or going over) static engine limits.
+//
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#endif
+
+#include "SDL.h"
+
+#include "i_system.h"
+#include "i_timer.h"
+#include "i_video.h"
+#include "m_argv.h"
+#include "m_misc.h"
+#include "v_video.h"
+#include "w_wad.h"
+#include "z_zone.h"
+#include "d_loop.h"
+#include "doomstat.h"
+#include "g_game.h"
+#include "p_local.h"
+#include "r_local.h"
+
+#include "crlcore.h"
+#include "crlvars.h"
+#include "crlscan.h"
+
+
+// Single rendered view.
+typedef struct
+{
+    fixed_t    x, y, z;
+    angle_t    angle;
+    CRL_Data_t data;
+    int        numplanes;  // Visplanes actually allocated.
+    int        crashed;    // CRLJustIncaseBuf longjmp fired.
+    int        valid;      // Viewpoint is inside the map.
+} scansample_t;
+
+static scansample_t *samples;
+static int numsamples;
+
+static fixed_t scan_minx, scan_miny;
+static fixed_t scan_step;
+static int     scan_nx, scan_ny;
+static int     scan_numangles;
+
+#define NUMWORSTSPOTS 20
+
+// -----------------------------------------------------------------------------
+// ScanParseMap
+//  Gets episode and map from "MAPxy", "ExMy" or plain map number.
+// -----------------------------------------------------------------------------
+
+static boolean ScanParseMap (const char *name, int *episode, int *map)
+{
+    char *uc_name = M_StringDuplicate(name);
+    char lumpname[9];
+    boolean result = false;
+
+    M_ForceUppercase(uc_name);
+
+    if (gamemode == commercial)
+    {
+        *episode = 1;
+        result = sscanf(uc_name, "MAP%d", map) == 1
+              || sscanf(uc_name, "%d", map) == 1;
+        M_snprintf(lumpname, sizeof(lumpname), "MAP%02d", *map);
+    }
+    else
+    {
+        result = sscanf(uc_name, "E%dM%d", episode, map) == 2;
+        M_snprintf(lumpname, sizeof(lumpname), "E%dM%d", *episode, *map);
+    }
+
+    free(uc_name);
+
+    return result && W_CheckNumForName(lumpname) >= 0;
+}
+
+// -----------------------------------------------------------------------------
+// ScanPointSector
+//  Returns sector the player could stand in at given point,
+//  or NULL if the point is in the void or in a closed sector.
+// -----------------------------------------------------------------------------
+
+static sector_t *ScanPointSector (fixed_t x, fixed_t y)
+{
+    const subsector_t *ss = R_PointInSubsector(x, y);
+    int i;
+
+    // Subsectors are convex, so the point must be
+    // on the front side of every seg bounding it.
+    for (i = 0 ; i < ss->numlines ; i++)
+    {
+        if (R_PointOnSegSide(x, y, &segs[ss->firstline + i]))
+        {
+            return NULL;
+        }
+    }
+
+    if (ss->sector->ceilingheight - ss->sector->floorheight
+    <   mobjinfo[MT_PLAYER].height)
+    {
+        return NULL;
+    }
+
+    return ss->sector;
+}
+
+// -----------------------------------------------------------------------------
+// ScanCells
+//  Renders every angle of every grid cell from first, stepping by stride.
+// -----------------------------------------------------------------------------
+
+static void ScanCells (int first, int stride)
+{
+    const int numcells = scan_nx * scan_ny;
+    int cell, i;
+
+    for (cell = first ; cell < numcells ; cell += stride)
+    {
+        const fixed_t x = scan_minx + (cell % scan_nx) * scan_step;
+        const fixed_t y = scan_miny + (cell / scan_nx) * scan_step;
+        const sector_t *sec = ScanPointSector(x, y);
+
+        if (sec == NULL)
+        {
+            continue;
+        }
+
+        for (i = 0 ; i < scan_numangles ; i++)
+        {
+            scansample_t *s = &samples[cell * scan_numangles + i];
+
+            s->x = x;
+            s->y = y;
+            s->z = sec->floorheight + VIEWHEIGHT;
+            s->angle = (angle_t)(((uint64_t) i << 32) / scan_numangles);
+
+            CRL_camera_x = CRL_camera_oldx = s->x;
+            CRL_camera_y = CRL_camera_oldy = s->y;
+            CRL_camera_z = CRL_camera_oldz = s->z;
+            CRL_camera_ang = CRL_camera_oldang = s->angle;
+
+            R_RenderPlayerView(&players[consoleplayer]);
+
+            s->data = CRLData;
+            s->numplanes = (int)(lastvisplane - visplanes);
+            s->crashed = CRL_FrameResult > 0;
+            s->valid = true;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// ScanSeverity
+//  How close the sample came to static limits, 1000 is exactly at limit.
+// -----------------------------------------------------------------------------
+
+static int ScanSeverity (const scansample_t *s)
+{
+    int sev;
+
+    if (!s->valid)
+    {
+        return -1;
+    }
+    if (s->crashed)
+    {
+        return INT_MAX;
+    }
+
+    sev = s->numplanes * 1000 / CRL_MaxVisPlanes;
+    sev = MAX(sev, s->data.numsegs * 1000 / CRL_MaxDrawSegs);
+    sev = MAX(sev, s->data.numsprites * 1000 / CRL_MaxVisSprites);
+    sev = MAX(sev, s->data.numopenings * 1000 / CRL_MaxOpenings);
+
+    return sev;
+}
+
+static int ScanCompareSeverity (const void *a, const void *b)
+{
+    const int sa = ScanSeverity(*(const scansample_t *const *) a);
+    const int sb = ScanSeverity(*(const scansample_t *const *) b);
+
+    return sa < sb ? 1 : sa > sb ? -1 : 0;
+}
+
+// -----------------------------------------------------------------------------
+// ScanWriteCSV
+//  Writes every valid sample, in grid order.
+// -----------------------------------------------------------------------------
+
+static void ScanWriteCSV (const char *filename)
+{
+    FILE *f = M_fopen(filename, "w");
+    int i;
+
+    if (f == NULL)
+    {
+        printf("CRL_LimitScan: unable to write %s\n", filename);
+        return;
+    }
+
+    fprintf(f, "x,y,z,angle,visplanes,checkplanes,findplanes,"
+               "drawsegs,solidsegs,sprites,openings,overflow,crashed\n");
+
+    for (i = 0 ; i < numsamples ; i++)
+    {
+        const scansample_t *s = &samples[i];
+
+        if (!s->valid)
+        {
+            continue;
+        }
+
+        fprintf(f, "%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n",
+                s->x >> FRACBITS, s->y >> FRACBITS, s->z >> FRACBITS,
+                (int)(((uint64_t) s->angle * 360) >> 32),
+                s->numplanes, s->data.numcheckplanes, s->data.numfindplanes,
+                s->data.numsegs, s->data.numsolidsegs, s->data.numsprites,
+                s->data.numopenings, ScanSeverity(s) > 1000, s->crashed);
+    }
+
+    fclose(f);
+}
+
+// -----------------------------------------------------------------------------
+// ScanWriteHeatmap
+//  Writes a binary PPM, one pixel per grid cell, worst angle wins.
+//  Black is void, green to yellow is 0-100% of limits,
+//  red is over the limit and magenta is a renderer crash.
+// -----------------------------------------------------------------------------
+
+static void ScanWriteHeatmap (const char *filename)
+{
+    FILE *f = M_fopen(filename, "wb");
+    int cx, cy, i;
+
+    if (f == NULL)
+    {
+        printf("CRL_LimitScan: unable to write %s\n", filename);
+        return;
+    }
+
+    fprintf(f, "P6\n%d %d\n255\n", scan_nx, scan_ny);
+
+    // Top row of the image is the north edge of the map.
+    for (cy = scan_ny - 1 ; cy >= 0 ; cy--)
+    {
+        for (cx = 0 ; cx < scan_nx ; cx++)
+        {
+            const scansample_t *s = &samples[(cy * scan_nx + cx) * scan_numangles];
+            byte rgb[3] = { 0, 0, 0 };
+            int sev = -1;
+
+            for (i = 0 ; i < scan_numangles ; i++)
+            {
+                sev = MAX(sev, ScanSeverity(&s[i]));
+            }
+
+            if (sev == INT_MAX)
+            {
+                rgb[0] = 255; rgb[2] = 255;
+            }
+            else if (sev > 1000)
+            {
+                rgb[0] = 255;
+            }
+            else if (sev >= 0)
+            {
+                rgb[0] = sev * 255 / 1000;
+                rgb[1] = 255;
+            }
+
+            fwrite(rgb, 1, sizeof(rgb), f);
+        }
+    }
+
+    fclose(f);
+}
+
+// -----------------------------------------------------------------------------
+// ScanRunWorkers
+//  Splits grid cells between worker processes. Renderer state is global,
+//  so each worker gets its own copy of it by forking after level setup,
+//  and results are gathered through shared memory.
+// -----------------------------------------------------------------------------
+
+static void ScanRunWorkers (int jobs)
+{
+#ifndef _WIN32
+    const size_t size = numsamples * sizeof(*samples);
+    pid_t *pids;
+    int i, status;
+
+    samples = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    if (samples == MAP_FAILED)
+    {
+        I_Error("CRL_LimitScan: failed to map %d samples", numsamples);
+    }
+
+    if (jobs > 1)
+    {
+        pids = malloc(jobs * sizeof(*pids));
+        fflush(stdout);
+
+        for (i = 0 ; i < jobs ; i++)
+        {
+            pids[i] = fork();
+
+            if (pids[i] == 0)
+            {
+                ScanCells(i, jobs);
+                _exit(0);
+            }
+            if (pids[i] < 0)
+            {
+                // Could not fork, do this slice ourselves.
+                ScanCells(i, jobs);
+            }
+        }
+
+        for (i = 0 ; i < jobs ; i++)
+        {
+            if (pids[i] > 0 && (waitpid(pids[i], &status, 0) < 0
+            || !WIFEXITED(status) || WEXITSTATUS(status) != 0))
+            {
+                printf("CRL_LimitScan: worker %d failed, "
+                       "its part of the map is incomplete.\n", i);
+            }
+        }
+
+        free(pids);
+        return;
+    }
+#else
+    samples = calloc(numsamples, sizeof(*samples));
+#endif
+
+    ScanCells(0, 1);
+}
+
+// -----------------------------------------------------------------------------
+// CRL_LimitScan
+//  [JN] Loads given map without a window and sweeps through it,
+//  writing CSV and heatmap of render limits usage. Never returns.
+// -----------------------------------------------------------------------------
+
+void CRL_LimitScan (const char *mapname, skill_t skill)
+{
+    const int old_spectating = crl_spectating;
+    const int old_uncapped_fps = crl_uncapped_fps;
+    const int old_visplanes_drawing = crl_visplanes_drawing;
+    fixed_t maxx, maxy;
+    scansample_t **worst;
+    char *outname, *filename;
+    int episode, map, jobs, numvalid, numworst, starttime;
+    int i, p;
+
+    if (!ScanParseMap(mapname, &episode, &map))
+    {
+        I_Error("CRL_LimitScan: map %s not found", mapname);
+    }
+
+    //!
+    // @arg <n>
+    // @category obscure
+    //
+    // Distance in map units between -limitscan viewpoints (default 64).
+    //
+
+    p = M_CheckParmWithArgs("-scanstep", 1);
+    scan_step = (p ? BETWEEN(8, 1024, atoi(myargv[p+1])) : 64) << FRACBITS;
+
+    //!
+    // @arg <n>
+    // @category obscure
+    //
+    // Number of view angles rendered at every -limitscan viewpoint
+    // (default 16).
+    //
+
+    p = M_CheckParmWithArgs("-scanangles", 1);
+    scan_numangles = p ? BETWEEN(1, 256, atoi(myargv[p+1])) : 16;
+
+    //!
+    // @arg <n>
+    // @category obscure
+    //
+    // Number of worker processes used by -limitscan
+    // (default is number of CPU cores).
+    //
+
+    p = M_CheckParmWithArgs("-scanjobs", 1);
+    jobs = p ? BETWEEN(1, 256, atoi(myargv[p+1])) : MAX(1, SDL_GetCPUCount());
+
+    // Render from spectator camera without interpolation.
+    // Config values are restored before quitting.
+    crl_spectating = 1;
+    crl_uncapped_fps = 0;
+    crl_visplanes_drawing = 0;
+    singletics = true;
+
+    G_InitNew(skill, episode, map);
+
+    // No window, draw into a private buffer.
+    I_VideoBuffer = Z_Malloc(SCREENAREA * sizeof(*I_VideoBuffer), PU_STATIC, NULL);
+    V_RestoreBuffer();
+    R_ExecuteSetViewSize();
+    CRLSurface = I_VideoBuffer;
+
+    // Grid covers bounding box of all vertexes.
+    scan_minx = maxx = vertexes[0].x;
+    scan_miny = maxy = vertexes[0].y;
+    for (i = 1 ; i < numvertexes ; i++)
+    {
+        scan_minx = MIN(scan_minx, vertexes[i].x);
+        scan_miny = MIN(scan_miny, vertexes[i].y);
+        maxx = MAX(maxx, vertexes[i].x);
+        maxy = MAX(maxy, vertexes[i].y);
+    }
+    scan_nx = (maxx - scan_minx) / scan_step + 1;
+    scan_ny = (maxy - scan_miny) / scan_step + 1;
+    numsamples = scan_nx * scan_ny * scan_numangles;
+
+    printf("CRL_LimitScan: %s, %dx%d grid, %d angles, %d jobs, %s limits.\n",
+           mapname, scan_nx, scan_ny, scan_numangles, jobs, CRL_LimitsName);
+
+    starttime = I_GetTimeMS();
+    ScanRunWorkers(jobs);
+
+    // Collect and sort valid samples, worst first.
+    worst = malloc(numsamples * sizeof(*worst));
+    for (i = 0, numvalid = 0 ; i < numsamples ; i++)
+    {
+        if (samples[i].valid)
+        {
+            worst[numvalid++] = &samples[i];
+        }
+    }
+    qsort(worst, numvalid, sizeof(*worst), ScanCompareSeverity);
+
+    printf("CRL_LimitScan: %d views rendered in %d ms.\n",
+           numvalid, I_GetTimeMS() - starttime);
+
+    numworst = MIN(numvalid, NUMWORSTSPOTS);
+    for (i = 0 ; i < numworst ; i++)
+    {
+        const scansample_t *s = worst[i];
+
+        printf("  X:%6d Y:%6d ANG:%3d  PLN:%4d/%d SEG:%4d/%d SPR:%4d/%d OPN:%6d/%d%s\n",
+               s->x >> FRACBITS, s->y >> FRACBITS,
+               (int)(((uint64_t) s->angle * 360) >> 32),
+               s->numplanes, CRL_MaxVisPlanes,
+               s->data.numsegs, CRL_MaxDrawSegs,
+               s->data.numsprites, CRL_MaxVisSprites,
+               s->data.numopenings, CRL_MaxOpenings,
+               s->crashed ? "  CRASH" : "");
+    }
+    free(worst);
+
+    //!
+    // @arg <name>
+    // @category obscure
+    //
+    // Base name for -limitscan output files (default is map name).
+    //
+
+    p = M_CheckParmWithArgs("-scanout", 1);
+    outname = p ? myargv[p+1] : (char *) mapname;
+
+    filename = M_StringJoin(outname, ".csv", NULL);
+    ScanWriteCSV(filename);
+    printf("CRL_LimitScan: wrote %s\n", filename);
+    free(filename);
+
+    filename = M_StringJoin(outname, ".ppm", NULL);
+    ScanWriteHeatmap(filename);
+    printf("CRL_LimitScan: wrote %s\n", filename);
+    free(filename);
+
+    crl_spectating = old_spectating;
+    crl_uncapped_fps = old_uncapped_fps;
+    crl_visplanes_drawing = old_visplanes_drawing;
+
+    I_Quit();
+}
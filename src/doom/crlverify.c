@@ -0,0 +1,568 @@
+//
+// Copyright(C) 2018-2024 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//  Headless batch demo verifier. Plays every demo from a directory
+//  without drawing, checksums game state of every tic and compares
+//  per-level checksums against a previously written baseline.
+//
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#endif
+
+#include "SDL.h"
+
+#include "i_glob.h"
+#include "i_sound.h"
+#include "i_system.h"
+#include "i_timer.h"
+#include "m_argv.h"
+#include "m_misc.h"
+#include "m_random.h"
+#include "w_wad.h"
+#include "d_loop.h"
+#include "doomstat.h"
+#include "g_game.h"
+#include "p_local.h"
+
+#include "crlcore.h"
+#include "crlverify.h"
+
+
+#define MAXVERIFYLEVELS 64
+
+// Checksum of a single level played by demo.
+typedef struct
+{
+    char     map[9];
+    int      starttic;
+    int      tics;
+    int      kills, items, secrets;
+    uint32_t hash;
+} verifylevel_t;
+
+// Result of a single demo, written by worker process.
+typedef struct
+{
+    boolean       done;       // Worker reached the end of demo.
+    int           numlevels;
+    verifylevel_t levels[MAXVERIFYLEVELS];
+} verifyresult_t;
+
+// Single line of baseline file.
+typedef struct
+{
+    char         *demo;
+    verifylevel_t level;
+} verifybase_t;
+
+static char **demos;
+static int numdemos;
+static verifyresult_t *results;
+
+static verifybase_t *baseline;
+static int numbaseline;
+
+// Tics are run without d_loop, which is what normally provides network
+// commands. Demo playback overwrites them anyway, but G_Ticker copies
+// them first, so they must be there.
+static ticcmd_t verifycmds[MAXPLAYERS];
+
+// -----------------------------------------------------------------------------
+// VerifyHash
+//  FNV-1a hash of a 32-bit value, byte by byte.
+// -----------------------------------------------------------------------------
+
+static uint32_t VerifyHash (uint32_t hash, int value)
+{
+    int i;
+
+    for (i = 0 ; i < 4 ; i++)
+    {
+        hash ^= (value >> (i * 8)) & 0xff;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+// -----------------------------------------------------------------------------
+// VerifyTicHash
+//  Adds game state of the current tic to hash: level time, random
+//  number index, players and every map object.
+// -----------------------------------------------------------------------------
+
+static uint32_t VerifyTicHash (uint32_t hash)
+{
+    const thinker_t *th;
+    int i;
+
+    hash = VerifyHash(hash, leveltime);
+    hash = VerifyHash(hash, prndindex);
+
+    for (i = 0 ; i < MAXPLAYERS ; i++)
+    {
+        const player_t *player = &players[i];
+
+        if (!playeringame[i] || player->mo == NULL)
+        {
+            continue;
+        }
+
+        hash = VerifyHash(hash, player->mo->x);
+        hash = VerifyHash(hash, player->mo->y);
+        hash = VerifyHash(hash, player->mo->z);
+        hash = VerifyHash(hash, player->mo->angle);
+        hash = VerifyHash(hash, player->health);
+        hash = VerifyHash(hash, player->armorpoints);
+        hash = VerifyHash(hash, player->killcount);
+        hash = VerifyHash(hash, player->itemcount);
+        hash = VerifyHash(hash, player->secretcount);
+    }
+
+    for (th = thinkercap.next ; th != &thinkercap ; th = th->next)
+    {
+        if (th->function.acp1 == (actionf_p1) P_MobjThinker)
+        {
+            const mobj_t *mo = (const mobj_t *) th;
+
+            hash = VerifyHash(hash, mo->type);
+            hash = VerifyHash(hash, mo->x);
+            hash = VerifyHash(hash, mo->y);
+            hash = VerifyHash(hash, mo->z);
+            hash = VerifyHash(hash, mo->health);
+        }
+    }
+
+    return hash;
+}
+
+// -----------------------------------------------------------------------------
+// VerifyCloseLevel
+//  Stores final counters of the level being played.
+// -----------------------------------------------------------------------------
+
+static void VerifyCloseLevel (verifylevel_t *level)
+{
+    int i;
+
+    level->tics = gametic - level->starttic;
+    level->kills = level->items = level->secrets = 0;
+
+    for (i = 0 ; i < MAXPLAYERS ; i++)
+    {
+        if (playeringame[i])
+        {
+            level->kills += players[i].killcount;
+            level->items += players[i].itemcount;
+            level->secrets += players[i].secretcount;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// VerifyDemo
+//  Plays demo without drawing and stores checksum of every level.
+// -----------------------------------------------------------------------------
+
+static void VerifyDemo (int num)
+{
+    verifyresult_t *r = &results[num];
+    verifylevel_t *level = NULL;
+    char lumpname[9];
+
+    if (W_AddFile(demos[num]) == NULL)
+    {
+        fprintf(stderr, "CRL_VerifyDemos: unable to load %s\n", demos[num]);
+        return;
+    }
+
+    W_GenerateHashTable();
+    M_StringCopy(lumpname, lumpinfo[numlumps - 1]->name, sizeof(lumpname));
+
+    G_DeferedPlayDemo(M_StringDuplicate(lumpname));
+    netcmds = verifycmds;
+
+    // First tic starts demo playback, the rest read demo commands
+    // until G_CheckDemoStatus ends it.
+    do
+    {
+        G_Ticker();
+        gametic++;
+
+        if (gamestate != GS_LEVEL || !demoplayback)
+        {
+            if (level != NULL)
+            {
+                VerifyCloseLevel(level);
+                level = NULL;
+            }
+            continue;
+        }
+
+        if (level == NULL || level->starttic != levelstarttic)
+        {
+            if (level != NULL)
+            {
+                VerifyCloseLevel(level);
+            }
+
+            if (r->numlevels == MAXVERIFYLEVELS)
+            {
+                fprintf(stderr, "CRL_VerifyDemos: %s has more than %d levels\n",
+                        demos[num], MAXVERIFYLEVELS);
+                return;
+            }
+
+            level = &r->levels[r->numlevels++];
+            level->starttic = levelstarttic;
+            level->hash = 2166136261u;
+
+            if (gamemode == commercial)
+                M_snprintf(level->map, sizeof(level->map), "MAP%02d", gamemap);
+            else
+                M_snprintf(level->map, sizeof(level->map), "E%dM%d",
+                           gameepisode, gamemap);
+        }
+
+        level->hash = VerifyTicHash(level->hash);
+    } while (demoplayback);
+
+    r->done = true;
+}
+
+// -----------------------------------------------------------------------------
+// VerifyRunWorkers
+//  Plays every demo in its own worker process, so demos can not affect
+//  each other and a demo bringing the engine down with I_Error only fails
+//  itself. Results are gathered through shared memory.
+// -----------------------------------------------------------------------------
+
+static void VerifyRunWorkers (int jobs)
+{
+#ifndef _WIN32
+    const size_t size = numdemos * sizeof(*results);
+    int next = 0, running = 0;
+    int status;
+
+    results = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    if (results == MAP_FAILED)
+    {
+        I_Error("CRL_VerifyDemos: failed to map %d results", numdemos);
+    }
+
+    memset(results, 0, size);
+    fflush(stdout);
+
+    while (next < numdemos || running > 0)
+    {
+        if (next < numdemos && running < jobs)
+        {
+            const pid_t pid = fork();
+
+            if (pid == 0)
+            {
+                // A failing demo must only leave its result behind,
+                // not save the config file or pop up a window.
+                I_QuietErrorExit();
+                VerifyDemo(next);
+                _exit(0);
+            }
+            if (pid < 0)
+            {
+                fprintf(stderr, "CRL_VerifyDemos: unable to start worker "
+                                "for %s\n", demos[next]);
+            }
+            else
+            {
+                running++;
+            }
+
+            next++;
+            continue;
+        }
+
+        if (wait(&status) > 0)
+        {
+            running--;
+        }
+        else
+        {
+            break;
+        }
+    }
+#else
+    int i;
+
+    results = calloc(numdemos, sizeof(*results));
+
+    for (i = 0 ; i < numdemos ; i++)
+    {
+        VerifyDemo(i);
+    }
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// VerifyReadBaseline
+//  Reads baseline file, as written by VerifyWriteResults.
+// -----------------------------------------------------------------------------
+
+static void VerifyReadBaseline (const char *filename)
+{
+    FILE *f = M_fopen(filename, "r");
+    char line[512];
+
+    if (f == NULL)
+    {
+        I_Error("CRL_VerifyDemos: unable to read baseline %s", filename);
+    }
+
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        verifybase_t base;
+        char demo[256];
+
+        memset(&base, 0, sizeof(base));
+
+        if (line[0] == '#'
+        ||  sscanf(line, "%255s %8s %d %d %d %d %x", demo, base.level.map,
+                   &base.level.tics, &base.level.kills, &base.level.items,
+                   &base.level.secrets, &base.level.hash) != 7)
+        {
+            continue;
+        }
+
+        base.demo = M_StringDuplicate(demo);
+        baseline = I_Realloc(baseline, (numbaseline + 1) * sizeof(*baseline));
+        baseline[numbaseline++] = base;
+    }
+
+    fclose(f);
+}
+
+// -----------------------------------------------------------------------------
+// VerifyCompare
+//  Compares demo result against baseline. Returns NULL if they match,
+//  or describes the first difference.
+// -----------------------------------------------------------------------------
+
+static const char *VerifyCompare (int num, char *buf, size_t size)
+{
+    const char *name = M_BaseName(demos[num]);
+    const verifyresult_t *r = &results[num];
+    int i, n = 0;
+
+    for (i = 0 ; i < numbaseline ; i++)
+    {
+        const verifylevel_t *base = &baseline[i].level;
+        const verifylevel_t *level = &r->levels[n];
+
+        if (strcasecmp(baseline[i].demo, name))
+        {
+            continue;
+        }
+
+        if (n >= r->numlevels)
+        {
+            M_snprintf(buf, size, "ended before level %d (%s)", n + 1, base->map);
+            return buf;
+        }
+
+        if (strcmp(level->map, base->map) || level->tics != base->tics
+        ||  level->hash != base->hash)
+        {
+            M_snprintf(buf, size, "level %d (%s): %d tics, hash %08x, "
+                       "baseline %s %d tics, hash %08x", n + 1, level->map,
+                       level->tics, level->hash, base->map, base->tics,
+                       base->hash);
+            return buf;
+        }
+
+        n++;
+    }
+
+    if (n == 0)
+    {
+        M_snprintf(buf, size, "not in baseline");
+        return buf;
+    }
+
+    if (n < r->numlevels)
+    {
+        M_snprintf(buf, size, "played extra level %d (%s)",
+                   n + 1, r->levels[n].map);
+        return buf;
+    }
+
+    return NULL;
+}
+
+// -----------------------------------------------------------------------------
+// VerifyWriteResults
+//  Writes checksum of every level of every demo, one line per level.
+// -----------------------------------------------------------------------------
+
+static void VerifyWriteResults (const char *filename)
+{
+    FILE *f = M_fopen(filename, "w");
+    int i, j;
+
+    if (f == NULL)
+    {
+        printf("CRL_VerifyDemos: unable to write %s\n", filename);
+        return;
+    }
+
+    fprintf(f, "# demo map tics kills items secrets hash\n");
+
+    for (i = 0 ; i < numdemos ; i++)
+    {
+        for (j = 0 ; j < results[i].numlevels ; j++)
+        {
+            const verifylevel_t *level = &results[i].levels[j];
+
+            fprintf(f, "%s %s %d %d %d %d %08x\n", M_BaseName(demos[i]),
+                    level->map, level->tics, level->kills, level->items,
+                    level->secrets, level->hash);
+        }
+    }
+
+    fclose(f);
+}
+
+// -----------------------------------------------------------------------------
+// CRL_VerifyDemos
+//  [JN] Plays every demo from given directory without a window,
+//  writes per-level checksums and compares them against baseline.
+//  Quits with an error if any demo failed. Never returns.
+// -----------------------------------------------------------------------------
+
+void CRL_VerifyDemos (const char *dir)
+{
+    glob_t *glob;
+    const char *filename;
+    char buf[256];
+    int jobs, starttime, failed = 0;
+    int i, p;
+
+    //!
+    // @arg <n>
+    // @category demo
+    //
+    // Number of worker processes used by -verifydemos
+    // (default is number of CPU cores).
+    //
+
+    p = M_CheckParmWithArgs("-verifyjobs", 1);
+    jobs = p ? BETWEEN(1, 256, atoi(myargv[p+1])) : MAX(1, SDL_GetCPUCount());
+
+    //!
+    // @arg <file>
+    // @category demo
+    //
+    // Compare -verifydemos checksums against file written by
+    // previous run with -verifyout.
+    //
+
+    p = M_CheckParmWithArgs("-verifybaseline", 1);
+
+    if (p)
+    {
+        VerifyReadBaseline(myargv[p+1]);
+    }
+
+    glob = I_StartGlob(dir, "*.lmp", GLOB_FLAG_NOCASE | GLOB_FLAG_SORTED);
+
+    while ((filename = I_NextGlob(glob)) != NULL)
+    {
+        demos = I_Realloc(demos, (numdemos + 1) * sizeof(*demos));
+        demos[numdemos++] = M_StringDuplicate(filename);
+    }
+
+    I_EndGlob(glob);
+
+    if (numdemos == 0)
+    {
+        I_Error("CRL_VerifyDemos: no demos found in %s", dir);
+    }
+
+    // No window and no sound, play the whole demo as fast as possible.
+    // Errors of a worker are seen from its results, not from a dialog.
+    I_ShutdownSound();
+    M_AddParm("-nogui");
+    nodrawers = true;
+    singletics = true;
+    singledemo = false;
+
+    printf("CRL_VerifyDemos: %d demos, %d jobs.\n", numdemos, jobs);
+
+    starttime = I_GetTimeMS();
+    VerifyRunWorkers(jobs);
+
+    for (i = 0 ; i < numdemos ; i++)
+    {
+        const char *name = M_BaseName(demos[i]);
+        const char *diff = NULL;
+
+        if (!results[i].done)
+        {
+            printf("  %-16s ERROR\n", name);
+            failed++;
+            continue;
+        }
+
+        if (baseline != NULL)
+        {
+            diff = VerifyCompare(i, buf, sizeof(buf));
+        }
+
+        printf("  %-16s %s, %d levels%s%s\n", name, diff ? "DESYNC" : "OK",
+               results[i].numlevels, diff ? ", " : "", diff ? diff : "");
+
+        if (diff != NULL)
+        {
+            failed++;
+        }
+    }
+
+    printf("CRL_VerifyDemos: %d of %d demos failed, %d ms.\n",
+           failed, numdemos, I_GetTimeMS() - starttime);
+
+    //!
+    // @arg <file>
+    // @category demo
+    //
+    // Write -verifydemos checksums to file (default verify.txt).
+    //
+
+    p = M_CheckParmWithArgs("-verifyout", 1);
+    VerifyWriteResults(p ? myargv[p+1] : "verify.txt");
+
+    if (failed)
+    {
+        I_Error("CRL_VerifyDemos: %d of %d demos failed", failed, numdemos);
+    }
+
+    I_Quit();
+}
@@ -743,6 +743,14 @@
 #define CRL_MDK_NA_P        "MDK NOT AVAILABLE IN DEMO PLAYING"
 #define CRL_MDK_NA_N        "MDK NOT AVAILABLE IN MULTIPLAYER GAME"
 
+#define CRL_REWIND_DONE     "REWOUND TO %d:%02d"
+#define CRL_REWIND_NONE     "NO SNAPSHOT TO REWIND TO"
+#define CRL_REWIND_NA_R     "REWIND NOT AVAILABLE IN DEMO RECORDING"
+#define CRL_REWIND_NA_P     "REWIND NOT AVAILABLE IN DEMO PLAYING"
+#define CRL_REWIND_NA_N     "REWIND NOT AVAILABLE IN MULTIPLAYER GAME"
+
+#define CRL_HOTRELOAD       "LEVEL RELOADED"
+
 #define CRL_AUTOMAPROTATE_ON     "ROTATE MODE ON"
 #define CRL_AUTOMAPROTATE_OFF    "ROTATE MODE OFF"
 #define CRL_AUTOMAPOVERLAY_ON    "OVERLAY MODE ON"
@@ -83,6 +83,9 @@
 #include "crlcore.h"
 #include "crlvars.h"
 #include "crlfunc.h"
+#include "crlmusic.h"
+#include "crlscan.h"
+#include "crlverify.h"
 
 //
 // D-DoomLoop()
@@ -311,7 +314,9 @@ static void D_Display (void)
     // and update while playing. This also needed for render counters update.
     if (automapactive)
     {
+        CRL_ProfStart(CRL_PROF_AUTOMAP);
         AM_Drawer();
+        CRL_ProfStop(CRL_PROF_AUTOMAP);
     }
 
     if (testcontrols)
@@ -340,8 +345,16 @@ static void D_Display (void)
     if (gamestate == GS_LEVEL)
     {
         // RestlessRodent -- draw visplanes if overlayed
+        CRL_ProfStart(CRL_PROF_VISPLANES);
         CRL_DrawVisPlanes(1);
+        CRL_ProfStop(CRL_PROF_VISPLANES);
+    }
+
+    CRL_ProfStart(CRL_PROF_HUD);
 
+    // [JN] Do not draw any CRL widgets if not in game level.
+    if (gamestate == GS_LEVEL)
+    {
         if (crl_extended_hud)
         {
             // RestlessRodent -- CRL Stats
@@ -413,10 +426,15 @@ static void D_Display (void)
     // [JN] Critical messages are drawn even higher than on top everything!
     CRL_DrawMessageCritical();
 
+    CRL_ProfStop(CRL_PROF_HUD);
+
     // normal update
     if (!wipe)
     {
+        CRL_ProfStart(CRL_PROF_PRESENT);
         I_FinishUpdate();  // page flip or blit buffer
+        CRL_ProfStop(CRL_PROF_PRESENT);
+        CRL_ProfFrame();
         return;
     }
 
@@ -593,7 +611,8 @@ void D_DoomLoop (void)
    	TryRunTics (); // will run at least one tic
 
 	// Update display, next frame, with current state.
-        if (screenvisible)
+	// [JN] Skip drawing if framerate limiter says it's too early.
+        if (screenvisible && I_FrameDue())
             D_Display ();
 
 	if (oldgametic < gametic)
@@ -2026,6 +2045,25 @@ void D_DoomMain (void)
     DEH_printf("I_Init: Setting up machine state.\n");
     I_CheckIsScreensaver();
     I_InitTimer();
+
+    //!
+    // @arg <lump> <file>
+    // @category obscure
+    //
+    // Render music lump through OPL emulation without an audio device,
+    // as fast as possible, write it to a WAV file and report
+    // emulation speed.
+    //
+
+    p = M_CheckParmWithArgs("-rendermusic", 2);
+
+    if (p)
+    {
+        // [JN] Handled before I_InitSound, so the audio device
+        // is never opened.
+        CRL_RenderMusic(myargv[p+1], myargv[p+2]);  // never returns
+    }
+
     I_InitJoystick();
     I_InitSound(doom);
     I_InitMusic();
@@ -2222,6 +2260,37 @@ void D_DoomMain (void)
         DEH_printf("External statistics registered.\n");
     }
 
+    //!
+    // @arg <map>
+    // @category obscure
+    //
+    // Load map (MAPxy or ExMy) without a window, render it from a grid
+    // of viewpoints and write CSV and heatmap of render limits usage.
+    //
+
+    p = M_CheckParmWithArgs("-limitscan", 1);
+
+    if (p)
+    {
+        CRL_LimitScan(myargv[p+1], startskill);  // never returns
+    }
+
+    //!
+    // @arg <dir>
+    // @category demo
+    //
+    // Play every .lmp demo from given directory without a window,
+    // using parallel worker processes, and check game state checksums
+    // of every level against baseline given with -verifybaseline.
+    //
+
+    p = M_CheckParmWithArgs("-verifydemos", 1);
+
+    if (p)
+    {
+        CRL_VerifyDemos(myargv[p+1]);  // never returns
+    }
+
     //!
     // @arg <x>
     // @category demo
@@ -2250,6 +2319,7 @@ void D_DoomMain (void)
     p = M_CheckParmWithArgs("-timedemo", 1);
     if (p)
     {
+	CRL_BenchStart(myargv[p + 1]);
 	G_TimeDemo (demolumpname);
 	D_DoomLoop ();  // never returns
     }
@@ -71,7 +71,9 @@ typedef enum
     ga_completed,
     ga_victory,
     ga_worlddone,
-    ga_screenshot
+    ga_screenshot,
+    ga_rewind,
+    ga_hotreload
 } gameaction_t;
 
 
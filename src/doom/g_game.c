@@ -129,6 +129,9 @@ boolean		netdemo;
 byte*		demobuffer;
 byte*		demo_p;
 byte*		demoend; 
+// [JN] Zone copy of the demo being played. NULL once it has been freed,
+// or handed over to demo continue mode as its recording buffer.
+static byte*	demoplaycopy;
 boolean         singledemo;            	// quit after playing a demo from cmdline 
  
 boolean         precache = true;        // if true, load all graphics at start 
@@ -975,6 +978,23 @@ void G_DoLoadLevel (void)
     }
 
     P_SetupLevel (gameepisode, gamemap, 0, gameskill);    
+
+    // [JN] Snapshots of the previous level can't be rewound to.
+    G_ClearSnapshots ();
+
+    // [JN] Start new map section of timedemo report.
+    if (timingdemo)
+    {
+        char name[9];
+
+        if (gamemode == commercial)
+            M_snprintf(name, sizeof(name), "MAP%02d", gamemap);
+        else
+            M_snprintf(name, sizeof(name), "E%dM%d", gameepisode, gamemap);
+
+        CRL_BenchMap(name, gametic);
+    }
+
     // view the guy you are playing
     // [JN] But do not reset choosen player view while demo playback.
     if (!demoplayback)
@@ -1366,6 +1386,29 @@ boolean G_Responder (event_t* ev)
                        CRL_VANILLA_LIMITS_ON : CRL_VANILLA_LIMITS_OFF, false, NULL);
     }     
 
+    // [JN] CRL - Rewind to the last snapshot.
+    if (ev->data1 == key_crl_rewind)
+    {
+        // Allow rewind only in single player game, otherwise desyncs may occur.
+        if (demorecording)
+        {
+            CRL_SetMessage(plr, CRL_REWIND_NA_R, false, NULL);
+            return true;
+        }
+        if (demoplayback)
+        {
+            CRL_SetMessage(plr, CRL_REWIND_NA_P, false, NULL);
+            return true;
+        }
+        if (netgame)
+        {
+            CRL_SetMessage(plr, CRL_REWIND_NA_N, false, NULL);
+            return true;
+        }
+
+        gameaction = ga_rewind;
+    }
+
 	return true;    // eat key down events 
  
       case ev_keyup: 
@@ -1492,6 +1535,12 @@ void G_Ticker (void)
             }
 	    gameaction = ga_nothing; 
 	    break; 
+	  case ga_rewind: 
+	    G_DoRewind (); 
+	    break; 
+	  case ga_hotreload: 
+	    G_DoHotReload (); 
+	    break; 
 	  case ga_nothing: 
 	    break; 
 	} 
@@ -1645,6 +1694,14 @@ void G_Ticker (void)
 	{
 		CT_Ticker ();
 	}
+	// [JN] CRL - take rewind snapshot.
+	G_TakeSnapshot ();
+	// [JN] CRL - reload the level once the '~' WAD has been saved.
+	if (singleplayer && gameaction == ga_nothing
+	&&  W_ReloadFileChanged(TICRATE))
+	{
+		gameaction = ga_hotreload;
+	}
 	// [JN] CRL - make multicolor HOM drawing framerate-independent.
 	CRL_GetHOMMultiColor ();
 	// [JN] Target's health widget.
@@ -2281,6 +2338,8 @@ void G_LoadGame (char* name)
 void G_DoLoadGame (void) 
 { 
     int savedleveltime;
+    int savelength;
+    byte *savebuffer;
 	 
     // [crispy] loaded game must always be single player.
     // Needed for ability to use a further game loading, as well as
@@ -2293,18 +2352,21 @@ void G_DoLoadGame (void)
     }
     gameaction = ga_nothing; 
 	 
-    save_stream = M_fopen(savename, "rb");
-
-    if (save_stream == NULL)
+    if (!M_FileExists(savename))
     {
         return;
     }
 
+    // [JN] Read the whole savegame at once and parse it from memory.
+    savelength = M_ReadFile(savename, &savebuffer);
+    save_stream = mem_fopen_read(savebuffer, savelength);
+
     savegame_error = false;
 
     if (!P_ReadSaveGameHeader())
     {
-        fclose(save_stream);
+        mem_fclose(save_stream);
+        Z_Free(savebuffer);
         return;
     }
 
@@ -2331,7 +2393,11 @@ void G_DoLoadGame (void)
     // [plums] Restore old sector specials.
     P_UnArchiveOldSpecials ();
 
-    fclose(save_stream);
+    mem_fclose(save_stream);
+    Z_Free(savebuffer);
+
+    // [JN] Older snapshots are not related to loaded game.
+    G_ClearSnapshots ();
     
     if (setsizeneeded)
 	R_ExecuteSetViewSize ();
@@ -2353,6 +2419,180 @@ void G_DoLoadGame (void)
 } 
  
 
+// -----------------------------------------------------------------------------
+// Rewind snapshots
+// [JN] A ring of in-memory level states, taken every crl_rewind_interval
+// tics. Restoring one does not touch the disk and does not set up the
+// level again, so retrying the same spot is instant.
+// -----------------------------------------------------------------------------
+
+#define REWINDSLOTS 16
+
+typedef struct
+{
+    byte   *data;
+    size_t  length;
+    size_t  alloced;
+    int     leveltime;
+    int     prndindex;
+} snapshot_t;
+
+static snapshot_t snapshots[REWINDSLOTS];
+static int snapshot_head;   // Next slot to write.
+static int snapshot_count;  // Valid slots before snapshot_head.
+
+void G_ClearSnapshots (void)
+{
+    snapshot_head = 0;
+    snapshot_count = 0;
+}
+
+void G_TakeSnapshot (void)
+{
+    snapshot_t *snap;
+    void *buf;
+    size_t len;
+
+    if (crl_rewind_interval <= 0 || !singleplayer
+    ||  leveltime == 0 || leveltime % crl_rewind_interval)
+    {
+        return;
+    }
+
+    // Paused game or menu does not advance leveltime.
+    if (snapshot_count > 0
+    &&  snapshots[(snapshot_head + REWINDSLOTS - 1) % REWINDSLOTS].leveltime == leveltime)
+    {
+        return;
+    }
+
+    save_stream = mem_fopen_write();
+    savegame_error = false;
+    P_ArchiveSnapshot();
+    mem_get_buf(save_stream, &buf, &len);
+
+    snap = &snapshots[snapshot_head];
+
+    if (len > snap->alloced)
+    {
+        snap->data = I_Realloc(snap->data, len);
+        snap->alloced = len;
+    }
+
+    memcpy(snap->data, buf, len);
+    snap->length = len;
+    snap->leveltime = leveltime;
+    snap->prndindex = prndindex;
+    mem_fclose(save_stream);
+
+    snapshot_head = (snapshot_head + 1) % REWINDSLOTS;
+
+    if (snapshot_count < REWINDSLOTS)
+    {
+        snapshot_count++;
+    }
+}
+
+void G_DoRewind (void)
+{
+    static char message[32];
+    snapshot_t *snap;
+    int slot;
+
+    gameaction = ga_nothing;
+
+    if (gamestate != GS_LEVEL || snapshot_count == 0)
+    {
+        CRL_SetMessage(&players[consoleplayer], CRL_REWIND_NONE, false, NULL);
+        return;
+    }
+
+    // Pick the newest snapshot that is at least a second old, so repeated
+    // presses walk further back, while a later press retries the same spot.
+    // Snapshots newer than the chosen one are dropped.
+    slot = (snapshot_head + REWINDSLOTS - 1) % REWINDSLOTS;
+
+    while (snapshot_count > 1
+    &&     leveltime - snapshots[slot].leveltime < TICRATE)
+    {
+        snapshot_head = slot;
+        snapshot_count--;
+        slot = (snapshot_head + REWINDSLOTS - 1) % REWINDSLOTS;
+    }
+
+    snap = &snapshots[slot];
+
+    save_stream = mem_fopen_read(snap->data, snap->length);
+    savegame_error = false;
+    P_UnArchiveSnapshot();
+    mem_fclose(save_stream);
+
+    leveltime = snap->leveltime;
+    prndindex = snap->prndindex;
+
+    M_snprintf(message, sizeof(message), CRL_REWIND_DONE,
+               leveltime / TICRATE / 60, leveltime / TICRATE % 60);
+    CRL_SetMessage(&players[consoleplayer], message, false, NULL);
+}
+
+// -----------------------------------------------------------------------------
+// G_DoHotReload
+//  [JN] The '~' reload WAD has been written by the map editor. Restart the
+//  current level in place, keeping the player's inventory, as well as
+//  position and view angle of both the player and the spectator camera.
+// -----------------------------------------------------------------------------
+
+void G_DoHotReload (void)
+{
+    player_t *const player = &players[consoleplayer];
+    mobj_t *mo = player->mo;
+    const fixed_t x = mo->x;
+    const fixed_t y = mo->y;
+    const fixed_t z = mo->z;
+    const angle_t angle = mo->angle;
+    const boolean onground = mo->z <= mo->floorz;
+    fixed_t cam_x, cam_y, cam_z;
+    angle_t cam_ang;
+
+    gameaction = ga_nothing;
+    CRL_GetCameraPos(&cam_x, &cam_y, &cam_z, &cam_ang);
+
+    G_DoLoadLevel();
+
+    // Put the player back where they were, within the new geometry.
+    mo = player->mo;
+    P_UnsetThingPosition(mo);
+    mo->x = x;
+    mo->y = y;
+    P_SetThingPosition(mo);
+
+    mo->floorz = mo->subsector->sector->floorheight;
+    mo->ceilingz = mo->subsector->sector->ceilingheight;
+    mo->z = onground ? mo->floorz : z;
+
+    if (mo->z + mo->height > mo->ceilingz)
+        mo->z = mo->ceilingz - mo->height;
+    if (mo->z < mo->floorz)
+        mo->z = mo->floorz;
+
+    mo->angle = angle;
+    mo->oldx = mo->x;
+    mo->oldy = mo->y;
+    mo->oldz = mo->z;
+    mo->oldangle = mo->angle;
+    player->viewz = mo->z + player->viewheight;
+
+    CRL_camera_x = CRL_camera_oldx = cam_x;
+    CRL_camera_y = CRL_camera_oldy = cam_y;
+    CRL_camera_z = CRL_camera_oldz = cam_z;
+    CRL_camera_ang = CRL_camera_oldang = cam_ang;
+
+    // Stay on the screen, no wipe.
+    wipegamestate = GS_LEVEL;
+
+    CRL_SetMessage(player, CRL_HOTRELOAD, false, NULL);
+}
+
 //
 // G_SaveGame
 // Called by the menu task.
@@ -2373,29 +2613,16 @@ void G_DoSaveGame (void)
     char *savegame_file;
     char *temp_savegame_file;
     char *recovery_savegame_file;
+    void *savebuffer;
+    size_t savebuffer_len;
 
     recovery_savegame_file = NULL;
     temp_savegame_file = P_TempSaveGameFile();
     savegame_file = P_SaveGameFile(savegameslot);
 
-    // Open the savegame file for writing.  We write to a temporary file
-    // and then rename it at the end if it was successfully written.
-    // This prevents an existing savegame from being overwritten by
-    // a corrupted one, or if a savegame buffer overrun occurs.
-    save_stream = M_fopen(temp_savegame_file, "wb");
-
-    if (save_stream == NULL)
-    {
-        // Failed to save the game, so we're going to have to abort. But
-        // to be nice, save to somewhere else before we call I_Error().
-        recovery_savegame_file = M_TempFile("recovery.dsg");
-        save_stream = M_fopen(recovery_savegame_file, "wb");
-        if (save_stream == NULL)
-        {
-            I_Error("Failed to open either '%s' or '%s' to write savegame.",
-                    temp_savegame_file, recovery_savegame_file);
-        }
-    }
+    // [JN] Serialize the savegame into memory first,
+    // it is flushed to disk with a single write below.
+    save_stream = mem_fopen_write();
 
     savegame_error = false;
 
@@ -2419,7 +2646,7 @@ void G_DoSaveGame (void)
     // Enforce the same savegame size limit as in Vanilla Doom,
     // except if the vanilla_savegame_limit setting is turned off.
 
-    if (vanilla_savegame_limit && ftell(save_stream) > SAVEGAMESIZE)
+    if (vanilla_savegame_limit && mem_ftell(save_stream) > SAVEGAMESIZE)
     {
         char *message = "Savegame overflow (vanilla crashes here)";
 
@@ -2429,9 +2656,27 @@ void G_DoSaveGame (void)
         CRL_SetMessageCritical("G_DoSaveGame:", message, MESSAGETICS);
     }
 
-    // Finish up, close the savegame file.
+    // Write the savegame to a temporary file and then rename it at
+    // the end if it was successfully written. This prevents an existing
+    // savegame from being overwritten by a corrupted one, or if a savegame
+    // buffer overrun occurs.
+    mem_get_buf(save_stream, &savebuffer, &savebuffer_len);
+
+    if (!M_WriteFile(temp_savegame_file, savebuffer, savebuffer_len))
+    {
+        // Failed to save the game, so we're going to have to abort. But
+        // to be nice, save to somewhere else before we call I_Error().
+        recovery_savegame_file = M_TempFile("recovery.dsg");
+        if (!M_WriteFile(recovery_savegame_file, savebuffer, savebuffer_len))
+        {
+            I_Error("Failed to open either '%s' or '%s' to write savegame.",
+                    temp_savegame_file, recovery_savegame_file);
+        }
+    }
+
+    // Finish up, close the savegame stream.
 
-    fclose(save_stream);
+    mem_fclose(save_stream);
 
     if (recovery_savegame_file != NULL)
     {
@@ -3013,13 +3258,25 @@ void G_DoPlayDemo (void)
         Z_Free(demobuffer);
     }
 
+    // [JN] Playback ended by starting a new game or by jumping to MAX
+    // visplanes doesn't go through G_CheckDemoStatus, free its copy.
+    if (demoplaycopy != NULL)
+    {
+        Z_Free(demoplaycopy);
+        demoplaycopy = NULL;
+    }
+
     lumpnum = W_GetNumForName(defdemoname);
     gameaction = ga_nothing;
-    demobuffer = W_CacheLumpNum(lumpnum, PU_STATIC);
+
+    // [JN] Demo continue mode grows and frees the buffer with Z_Free,
+    // which a lump in a memory-mapped WAD can not be, so read a copy.
+    lumplength = W_LumpLength(lumpnum);
+    demobuffer = demoplaycopy = Z_Malloc(lumplength + 1, PU_STATIC, NULL);
+    W_ReadLump(lumpnum, demobuffer);
     demo_p = demobuffer;
 
     // [crispy] ignore empty demo lumps
-    lumplength = W_LumpLength(lumpnum);
     if (lumplength < 0xd)
     {
 	demoplayback = true;
@@ -3327,6 +3584,9 @@ boolean G_CheckDemoStatus (void)
         timingdemo = false;
         demoplayback = false;
 
+        // [JN] Print frame time statistics and write JSON report.
+        CRL_BenchReport(gametic, realtics);
+
         i_error_safe = true;
         I_Error ("Timed %i gametics in %i realtics.\n"
                  "Average fps: %f", gametic, realtics, fps);
@@ -3334,7 +3594,12 @@ boolean G_CheckDemoStatus (void)
 	 
     if (demoplayback) 
     { 
-        W_ReleaseLumpName(defdemoname);
+        // [JN] In demo continue mode the buffer is grown below instead.
+        if (!demorecording)
+        {
+            Z_Free(demobuffer);
+        }
+        demoplaycopy = NULL;
 	demoplayback = false; 
 	netdemo = false;
 	netgame = false;
@@ -40,6 +40,7 @@ extern int G_VanillaVersionCode(void);
 
 extern void G_BeginRecording (void);
 extern void G_BuildTiccmd (ticcmd_t *cmd, int maketic); 
+extern void G_ClearSnapshots (void);
 extern void G_DeathMatchSpawnPlayer (int playernum);
 extern void G_DeferedInitNew (skill_t skill, int episode, int map);
 extern void G_DeferedPlayDemo (const char *demo);
@@ -49,6 +50,8 @@ extern void G_DoLoadLevel (void);
 extern void G_DoNewGame (void); 
 extern void G_DoPlayDemo (void); 
 extern void G_DoReborn (int playernum); 
+extern void G_DoRewind (void);
+extern void G_DoHotReload (void);
 extern void G_DoSaveGame (void); 
 extern void G_DoVictory (void); 
 extern void G_DoWorldDone (void); 
@@ -58,6 +61,7 @@ extern void G_InitNew (skill_t skill, int episode, int map);
 extern void G_LoadGame (char *name);
 extern void G_PlayDemo (char *name);
 extern void G_PlayerReborn (int player);
+extern void G_TakeSnapshot (void);
 extern void G_ReadDemoTiccmd (ticcmd_t *cmd); 
 extern void G_RecordDemo (const char *name);
 extern void G_SaveGame (int slot, char *description);
@@ -1292,7 +1292,8 @@ static void M_DrawCRL_Video (void)
                  M_Item_Glow(2, crl_vsync ? GLOW_GREEN : GLOW_DARKRED));
 
     // Show FPS counter
-    sprintf(str, crl_showfps ? "ON" : "OFF");
+    sprintf(str, crl_showfps == 1 ? "ON" :
+                 crl_showfps == 2 ? "PROFILE" : "OFF");
     M_WriteText (M_ItemRightAlign(str), 61, str, 
                  M_Item_Glow(3, crl_showfps ? GLOW_GREEN : GLOW_DARKRED));
 
@@ -1407,7 +1408,7 @@ static void M_CRL_VSync (int choice)
 
 static void M_CRL_ShowFPS (int choice)
 {
-    crl_showfps ^= 1;
+    crl_showfps = M_INT_Slider(crl_showfps, 0, 2, choice, false);
 }
 
 static void M_CRL_PixelScaling (int choice)
@@ -1683,6 +1684,7 @@ static void M_CRL_SFXSystem (int choice)
 
     // Start sound/music system
     I_InitSound(doom);
+    S_LimitChannels();
 
     // Re-generate SFX cache
     I_PrecacheSounds(S_sfx, NUMSFX);
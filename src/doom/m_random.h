@@ -26,6 +26,9 @@
 #include "doomtype.h"
 
 
+// Index of the play simulation random number table.
+extern int prndindex;
+
 // Returns a number from 0 to 255,
 // from a lookup table.
 int M_Random (void);
@@ -25,12 +25,14 @@
 #include "m_misc.h"
 #include "m_random.h"
 #include "i_system.h"
+#include "z_zone.h"
 #include "p_local.h"
 #include "s_sound.h"
 #include "g_game.h"
 #include "doomstat.h"
 
 #include "crlcore.h"
+#include "crlvars.h"
 
 
 typedef enum
@@ -73,11 +75,105 @@ dirtype_t diags[] =
 //
 
 
+// -----------------------------------------------------------------------------
+// Sound portals
+//  [JN] Every two-sided line of every sector, flattened at level load into
+//  one table together with the sector behind it and its ML_SOUNDBLOCK flag.
+//  soundportalstart[i] .. soundportalstart[i+1] are the portals of sector i,
+//  in the same order as sectors[i].lines.
+// -----------------------------------------------------------------------------
+
+typedef struct
+{
+    line_t   *line;
+    sector_t *other;
+    boolean   soundblock;
+} soundportal_t;
+
+static soundportal_t *soundportals;
+static int           *soundportalstart;
+
+// Sectors still to be flooded, and the soundblocks count each one is
+// reached with.
+typedef struct
+{
+    sector_t *sector;
+    int       soundblocks;
+} soundnode_t;
+
+static soundnode_t *soundstack;
+
+// [JN] Work done by the last noise alert, for the sound propagation view.
+int soundstats[NUMSOUNDSTATS];
+
+// -----------------------------------------------------------------------------
+// P_InitSoundPortals
+//  [JN] Called by P_SetupLevel after P_GroupLines.
+// -----------------------------------------------------------------------------
+
+void P_InitSoundPortals (void)
+{
+    int i, j;
+    int count = 0;
+
+    for (i = 0 ; i < numlines ; i++)
+    {
+        if ((lines[i].flags & ML_TWOSIDED) && lines[i].sidenum[1] != -1)
+        {
+            count += lines[i].backsector != lines[i].frontsector ? 2 : 1;
+        }
+    }
+
+    soundportals = Z_Malloc((count + 1) * sizeof(*soundportals), PU_LEVEL, 0);
+    soundportalstart = Z_Malloc((numsectors + 1) * sizeof(*soundportalstart),
+                                PU_LEVEL, 0);
+    // A sector is flooded at most twice (unblocked and blocked), and
+    // pushes at most one entry per portal each time.
+    soundstack = Z_Malloc((2 * count + 1) * sizeof(*soundstack), PU_LEVEL, 0);
+
+    count = 0;
+
+    for (i = 0 ; i < numsectors ; i++)
+    {
+        sector_t *const sec = &sectors[i];
+
+        soundportalstart[i] = count;
+
+        for (j = 0 ; j < sec->linecount ; j++)
+        {
+            line_t *const check = sec->lines[j];
+
+            // Single-sided lines, including "impassible glass" hack lines
+            // without a back side, never pass sound.
+            if (!(check->flags & ML_TWOSIDED) || check->sidenum[1] == -1)
+            {
+                continue;
+            }
+
+            soundportals[count].line = check;
+            soundportals[count].other =
+                sides[check->sidenum[0]].sector == sec ?
+                sides[check->sidenum[1]].sector :
+                sides[check->sidenum[0]].sector;
+            soundportals[count].soundblock = (check->flags & ML_SOUNDBLOCK) != 0;
+            count++;
+        }
+    }
+
+    soundportalstart[numsectors] = count;
+}
+
 //
 // Called by P_NoiseAlert.
-// Recursively traverse adjacent sectors,
+// Traverse adjacent sectors,
 // sound blocking lines cut off traversal.
 //
+// [JN] Flooded with an explicit stack over the sound portal table rather
+// than by recursion. A sector is only entered again if it is reached with
+// fewer sound blocks than before, so the flood converges on the same
+// soundtraversed/soundtarget/validcount state as the recursive walk,
+// whatever the visiting order.
+//
 
 mobj_t*		soundtarget;
 
@@ -86,49 +182,77 @@ P_RecursiveSound
 ( sector_t*	sec,
   int		soundblocks )
 {
-    int		i;
-    line_t*	check;
-    sector_t*	other;
-	
-    // wake up all monsters in this sector
-    if (sec->validcount == validcount
-	&& sec->soundtraversed <= soundblocks+1)
-    {
-	return;		// already flooded
-    }
-    
-    sec->validcount = validcount;
-    sec->soundtraversed = soundblocks+1;
-    sec->soundtarget = soundtarget;
-	
-    for (i=0 ;i<sec->linecount ; i++)
+    int			sp = 0;
+    int			i;
+    const soundportal_t*	portal;
+    line_t*		check;
+    fixed_t		opentop;
+    fixed_t		openbottom;
+
+    soundstats[0] = soundstats[1] = 0;
+
+    soundstack[sp].sector = sec;
+    soundstack[sp].soundblocks = soundblocks;
+    sp++;
+
+    while (sp > 0)
     {
-	check = sec->lines[i];
+	sp--;
+	sec = soundstack[sp].sector;
+	soundblocks = soundstack[sp].soundblocks;
+
+	// wake up all monsters in this sector
+	if (sec->validcount == validcount
+	    && sec->soundtraversed <= soundblocks+1)
+	{
+	    continue;		// already flooded
+	}
+
+	sec->validcount = validcount;
+	sec->soundtraversed = soundblocks+1;
+	sec->soundtarget = soundtarget;
+	soundstats[0]++;
 
 	// [JN] CRL - Sound propagation mode﻿ for automap.
 	// Set line timer for drawing.
-	check->sndprop_tics = (TICRATE / 3.5);
+	if (crl_automap_sndprop)
+	{
+	    for (i=0 ;i<sec->linecount ; i++)
+		sec->lines[i]->sndprop_tics = (TICRATE / 3.5);
+	}
 
-	if (! (check->flags & ML_TWOSIDED) )
-	    continue;
-	
-	P_LineOpening (check);
+	i = sec - sectors;
+	portal = &soundportals[soundportalstart[i]];
 
-	if (openrange <= 0)
-	    continue;	// closed door
-	
-	if ( sides[ check->sidenum[0] ].sector == sec)
-	    other = sides[ check->sidenum[1] ] .sector;
-	else
-	    other = sides[ check->sidenum[0] ].sector;
-	
-	if (check->flags & ML_SOUNDBLOCK)
+	for ( ; portal < &soundportals[soundportalstart[i+1]] ; portal++)
 	{
-	    if (!soundblocks)
-		P_RecursiveSound (other, 1);
+	    soundstats[1]++;
+	    check = portal->line;
+
+	    // same as P_LineOpening, without touching its globals
+	    opentop = MIN(check->frontsector->ceilingheight,
+			  check->backsector->ceilingheight);
+	    openbottom = MAX(check->frontsector->floorheight,
+			     check->backsector->floorheight);
+
+	    if (opentop - openbottom <= 0)
+		continue;	// closed door
+
+	    if (portal->soundblock)
+	    {
+		if (soundblocks)
+		    continue;
+
+		soundstack[sp].sector = portal->other;
+		soundstack[sp].soundblocks = 1;
+	    }
+	    else
+	    {
+		soundstack[sp].sector = portal->other;
+		soundstack[sp].soundblocks = soundblocks;
+	    }
+	    sp++;
 	}
-	else
-	    P_RecursiveSound (other, soundblocks);
     }
 }
 
@@ -1847,12 +1971,18 @@ int		numbraintargets = 0; // [crispy] initialize
 int		braintargeton = 0;
 static int	maxbraintargets; // [crispy] remove braintargets limit
 
-void A_BrainAwake (mobj_t* mo)
+// -----------------------------------------------------------------------------
+// P_FindBrainTargets
+//  [JN] Collects all the target spots in thinker order. Split out of
+//  A_BrainAwake, so a restored rewind snapshot can point the list at
+//  its own mobjs.
+// -----------------------------------------------------------------------------
+
+void P_FindBrainTargets (void)
 {
     thinker_t*	thinker;
     mobj_t*	m;
 	
-    // find all the target spots
     numbraintargets = 0;
     braintargeton = 0;
 	
@@ -1882,6 +2012,12 @@ void A_BrainAwake (mobj_t* mo)
 	    numbraintargets++;
 	}
     }
+}
+
+void A_BrainAwake (mobj_t* mo)
+{
+    // find all the target spots
+    P_FindBrainTargets ();
 	
     S_StartSound (NULL,sfx_bossit);
 }
@@ -23,6 +23,7 @@
 #include "doomdef.h"
 #include "d_event.h"
 #include "r_local.h"
+#include "memio.h"
 
 
 #define MAXHEALTH       (100)
@@ -223,8 +224,17 @@ extern void A_VileChase (mobj_t *actor);
 extern void A_VileStart (mobj_t *actor);
 extern void A_VileTarget (mobj_t *actor);
 extern void A_XScream (mobj_t *actor);
+extern void P_FindBrainTargets (void);
 extern void P_ForgetPlayer (player_t *player);
 extern void P_NoiseAlert (mobj_t *target, mobj_t *emmiter);
+extern void P_InitSoundPortals (void);
+
+// [JN] Sectors flooded and sound portals tested by the last noise alert.
+#define NUMSOUNDSTATS 2
+extern int soundstats[NUMSOUNDSTATS];
+
+extern int numbraintargets;
+extern int braintargeton;
 
 // -----------------------------------------------------------------------------
 // P_FLOOR
@@ -599,6 +609,7 @@ extern char    *P_SaveGameFile(int slot);
 extern char    *P_TempSaveGameFile(void);
 extern void     P_ArchiveOldSpecials (void);
 extern void     P_ArchivePlayers (void);
+extern void     P_ArchiveSnapshot (void);
 extern void     P_ArchiveSpecials (void);
 extern void     P_ArchiveThinkers (void);
 extern void     P_ArchiveTotalTimes (void);
@@ -606,6 +617,7 @@ extern void     P_ArchiveWorld (void);
 extern void     P_RestoreTargets (void);
 extern void     P_UnArchiveOldSpecials (void);
 extern void     P_UnArchivePlayers (void);
+extern void     P_UnArchiveSnapshot (void);
 extern void     P_UnArchiveSpecials (void);
 extern void     P_UnArchiveThinkers (void);
 extern void     P_UnArchiveTotalTimes (void);
@@ -613,7 +625,7 @@ extern void     P_UnArchiveWorld (void);
 extern void     P_WriteSaveGameEOF(void);
 extern void     P_WriteSaveGameHeader(char *description);
 
-extern FILE    *save_stream;
+extern MEMFILE *save_stream;
 extern boolean  savegame_error;
 
 extern const uint32_t P_ThinkerToIndex (const thinker_t *thinker);
@@ -644,6 +656,13 @@ extern const char *level_name;
 extern fixed_t topslope;
 extern fixed_t bottomslope;
 
+// [JN] REJECT hits, BSP traversals and nodes visited in the last tic.
+#define NUMSIGHTSTATS 3
+extern int sightstats[NUMSIGHTSTATS];
+
+extern void P_InitSightStack (void);
+extern void P_SightTicker (void);
+
 // -----------------------------------------------------------------------------
 // P_SPEC
 // -----------------------------------------------------------------------------
@@ -661,6 +680,7 @@ extern int     P_FindMinSurroundingLight (sector_t *sector, int max);
 extern int     P_FindSectorFromLineTag (line_t *line, int start);
 extern void    P_CrossSpecialLine (int linenum, int side, mobj_t *thing);
 extern void    P_InitPicAnims (void);
+extern void    P_MarkAnimatedTextures (char *present);
 extern void    P_PlayerInSpecialSector (player_t *player);
 extern void    P_ShootSpecialLine (mobj_t *thing, line_t *line);
 extern void    P_SpawnSpecials (void);
@@ -716,6 +736,7 @@ typedef struct
 
 extern void P_ChangeSwitchTexture (line_t *line, int useAgain);
 extern void P_InitSwitchList (void);
+extern void P_MarkSwitchTextures (char *present);
 
 extern button_t	buttonlist[MAXBUTTONS]; 
 
@@ -730,6 +751,9 @@ extern int EV_Teleport (line_t *line, int side, mobj_t *thing);
 // -----------------------------------------------------------------------------
 
 extern void P_InitThinkers (void);
+extern void P_InitThinkerPools (void);
+extern void *P_AllocThinker (size_t size);
+extern void P_FreeThinker (thinker_t *thinker);
 extern void P_AddThinker (thinker_t *thinker);
 extern void P_RemoveThinker (thinker_t *thinker);
 extern void P_Ticker (void);
@@ -30,15 +30,20 @@
 #include "g_game.h"
 #include "m_misc.h"
 #include "m_menu.h"
+#include "memio.h"
+#include "s_sound.h"
 
 #include "crlcore.h"
 #include "crlvars.h"
 
 
-FILE *save_stream;
+MEMFILE *save_stream;
 int savegamelength;
 boolean savegame_error;
 
+// [JN] Set while a rewind snapshot is being restored.
+static boolean snapshot_restore;
+
 // Get the filename of a temporary file to write the savegame to.  After
 // the file has been successfully saved, it will be renamed to the 
 // real file.
@@ -81,7 +86,7 @@ static byte saveg_read8(void)
 {
     byte result = -1;
 
-    if (fread(&result, 1, 1, save_stream) < 1)
+    if (mem_fread(&result, 1, 1, save_stream) < 1)
     {
         if (!savegame_error)
         {
@@ -100,7 +105,7 @@ static byte saveg_read8(void)
 
 static void saveg_write8(byte value)
 {
-    if (fwrite(&value, 1, 1, save_stream) < 1)
+    if (mem_fwrite(&value, 1, 1, save_stream) < 1)
     {
         if (!savegame_error)
         {
@@ -155,7 +160,7 @@ static void saveg_read_pad(void)
     int padding;
     int i;
 
-    pos = ftell(save_stream);
+    pos = mem_ftell(save_stream);
 
     padding = (4 - (pos & 3)) & 3;
 
@@ -171,7 +176,7 @@ static void saveg_write_pad(void)
     int padding;
     int i;
 
-    pos = ftell(save_stream);
+    pos = mem_ftell(save_stream);
 
     padding = (4 - (pos & 3)) & 3;
 
@@ -1608,9 +1613,21 @@ void P_UnArchiveThinkers (void)
 	next = currentthinker->next;
 	
 	if (currentthinker->function.acp1 == (actionf_p1)P_MobjThinker)
-	    P_RemoveMobj ((mobj_t *)currentthinker);
+	{
+	    // [JN] P_RemoveMobj only marks the mobj for removal, and it is
+	    // never freed once the list is dropped below. Rewinding does
+	    // this many times per level, so free it right away.
+	    if (snapshot_restore)
+	    {
+	        P_UnsetThingPosition ((mobj_t *)currentthinker);
+	        S_StopSound ((mobj_t *)currentthinker);
+	        P_FreeThinker (currentthinker);
+	    }
+	    else
+	        P_RemoveMobj ((mobj_t *)currentthinker);
+	}
 	else
-	    Z_Free (currentthinker);
+	    P_FreeThinker (currentthinker);
 
 	currentthinker = next;
     }
@@ -1627,11 +1644,12 @@ void P_UnArchiveThinkers (void)
 			
 	  case tc_mobj:
 	    saveg_read_pad();
-	    mobj = Z_Malloc (sizeof(*mobj), PU_LEVEL, NULL);
+	    mobj = P_AllocThinker (sizeof(*mobj));
             saveg_read_mobj_t(mobj);
 
 	    // [JN] Optionally restore monster targets.
-	    if (!crl_restore_targets)
+	    // Rewind snapshots always keep them.
+	    if (!crl_restore_targets && !snapshot_restore)
 	    {
 	        mobj->target = NULL;
 	        mobj->tracer = NULL;
@@ -1640,6 +1658,12 @@ void P_UnArchiveThinkers (void)
 	    mobj->info = &mobjinfo[mobj->type];
 	    mobj->floorz = mobj->subsector->sector->floorheight;
 	    mobj->ceilingz = mobj->subsector->sector->ceilingheight;
+	    // [JN] Do not interpolate from stale positions.
+	    mobj->interp = false;
+	    mobj->oldx = mobj->x;
+	    mobj->oldy = mobj->y;
+	    mobj->oldz = mobj->z;
+	    mobj->oldangle = mobj->angle;
 	    mobj->thinker.function.acp1 = (actionf_p1)P_MobjThinker;
 	    P_AddThinker (&mobj->thinker);
 	    break;
@@ -1795,7 +1819,7 @@ void P_UnArchiveSpecials (void)
 			
 	  case tc_ceiling:
 	    saveg_read_pad();
-	    ceiling = Z_Malloc (sizeof(*ceiling), PU_LEVEL, NULL);
+	    ceiling = P_AllocThinker (sizeof(*ceiling));
             saveg_read_ceiling_t(ceiling);
 	    ceiling->sector->specialdata = ceiling;
 
@@ -1808,7 +1832,7 @@ void P_UnArchiveSpecials (void)
 				
 	  case tc_door:
 	    saveg_read_pad();
-	    door = Z_Malloc (sizeof(*door), PU_LEVEL, NULL);
+	    door = P_AllocThinker (sizeof(*door));
             saveg_read_vldoor_t(door);
 	    door->sector->specialdata = door;
 	    door->thinker.function.acp1 = (actionf_p1)T_VerticalDoor;
@@ -1817,7 +1841,7 @@ void P_UnArchiveSpecials (void)
 				
 	  case tc_floor:
 	    saveg_read_pad();
-	    floor = Z_Malloc (sizeof(*floor), PU_LEVEL, NULL);
+	    floor = P_AllocThinker (sizeof(*floor));
             saveg_read_floormove_t(floor);
 	    floor->sector->specialdata = floor;
 	    floor->thinker.function.acp1 = (actionf_p1)T_MoveFloor;
@@ -1826,7 +1850,7 @@ void P_UnArchiveSpecials (void)
 				
 	  case tc_plat:
 	    saveg_read_pad();
-	    plat = Z_Malloc (sizeof(*plat), PU_LEVEL, NULL);
+	    plat = P_AllocThinker (sizeof(*plat));
             saveg_read_plat_t(plat);
 	    plat->sector->specialdata = plat;
 
@@ -1839,7 +1863,7 @@ void P_UnArchiveSpecials (void)
 				
 	  case tc_flash:
 	    saveg_read_pad();
-	    flash = Z_Malloc (sizeof(*flash), PU_LEVEL, NULL);
+	    flash = P_AllocThinker (sizeof(*flash));
             saveg_read_lightflash_t(flash);
 	    flash->thinker.function.acp1 = (actionf_p1)T_LightFlash;
 	    P_AddThinker (&flash->thinker);
@@ -1847,7 +1871,7 @@ void P_UnArchiveSpecials (void)
 				
 	  case tc_strobe:
 	    saveg_read_pad();
-	    strobe = Z_Malloc (sizeof(*strobe), PU_LEVEL, NULL);
+	    strobe = P_AllocThinker (sizeof(*strobe));
             saveg_read_strobe_t(strobe);
 	    strobe->thinker.function.acp1 = (actionf_p1)T_StrobeFlash;
 	    P_AddThinker (&strobe->thinker);
@@ -1855,7 +1879,7 @@ void P_UnArchiveSpecials (void)
 				
 	  case tc_glow:
 	    saveg_read_pad();
-	    glow = Z_Malloc (sizeof(*glow), PU_LEVEL, NULL);
+	    glow = P_AllocThinker (sizeof(*glow));
             saveg_read_glow_t(glow);
 	    glow->thinker.function.acp1 = (actionf_p1)T_Glow;
 	    P_AddThinker (&glow->thinker);
@@ -2019,3 +2043,73 @@ void P_UnArchiveOldSpecials (void)
             sec->oldspecial = 0;
     }
 }
+
+// -----------------------------------------------------------------------------
+// P_ArchiveSnapshot
+// [JN] Writes the state of the current level into save_stream for rewinding.
+// Unlike savegames, there is no header and no EOF marker, the level itself
+// is not set up again when the snapshot is restored.
+// -----------------------------------------------------------------------------
+
+void P_ArchiveSnapshot (void)
+{
+    P_ArchivePlayers ();
+    P_ArchiveWorld ();
+    P_ArchiveThinkers ();
+    P_ArchiveSpecials ();
+    P_ArchiveOldSpecials ();
+
+    // Boss brain targets point at mobjs, which are all reallocated
+    // on restore, so only their number and the next one to spit at
+    // are kept.
+    saveg_write32(numbraintargets);
+    saveg_write32(braintargeton);
+}
+
+// -----------------------------------------------------------------------------
+// P_UnArchiveSnapshot
+// [JN] Restores a snapshot written by P_ArchiveSnapshot over the running level.
+// -----------------------------------------------------------------------------
+
+void P_UnArchiveSnapshot (void)
+{
+    int i;
+
+    // Active plats and ceilings are about to be freed along with
+    // their thinkers, and pending switches are not archived at all.
+    for (i = 0 ; i < MAXCEILINGS ; i++)
+    {
+        activeceilings[i] = NULL;
+    }
+    for (i = 0 ; i < MAXPLATS ; i++)
+    {
+        activeplats[i] = NULL;
+    }
+    for (i = 0 ; i < MAXBUTTONS ; i++)
+    {
+        memset(&buttonlist[i], 0, sizeof(button_t));
+    }
+
+    snapshot_restore = true;
+
+    P_UnArchivePlayers ();
+    P_UnArchiveWorld ();
+    P_UnArchiveThinkers ();
+    P_UnArchiveSpecials ();
+    P_RestoreTargets ();
+    P_UnArchiveOldSpecials ();
+
+    // The target list is gathered again from the restored thinkers,
+    // they are in the same order as when A_BrainAwake went over them.
+    numbraintargets = saveg_read32();
+    i = saveg_read32();
+
+    if (numbraintargets > 0)
+    {
+        P_FindBrainTargets ();
+    }
+
+    braintargeton = numbraintargets > 0 ? i % numbraintargets : i;
+
+    snapshot_restore = false;
+}
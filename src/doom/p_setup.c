@@ -1015,9 +1015,17 @@ P_SetupLevel
 
     // UNUSED W_Profile ();
     P_InitThinkers ();
+    P_InitThinkerPools ();
 
     // if working with a devlopment map, reload it
-    W_Reload ();
+    // [JN] Textures, flats and sprites only have to be set up
+    // again if more than just the maps has changed.
+    if (W_Reload () == W_RELOAD_RESOURCES)
+    {
+        R_ReloadData ();
+        P_InitPicAnims ();
+        P_InitSwitchList ();
+    }
 
     // find map name
     if ( gamemode == commercial)
@@ -1048,18 +1056,29 @@ P_SetupLevel
     // [JN] CRL - check for unsupported nodes.
     P_CheckMapFormat(lumpnum);
 
+    // [JN] Let mapped WADs read the level lumps in the background.
+    for (i = ML_THINGS ; i <= ML_BLOCKMAP ; i++)
+    {
+        W_PrefetchLumpNum(lumpnum + i);
+    }
+
     // note: most of this ordering is important	
     P_LoadBlockMap (lumpnum+ML_BLOCKMAP);
     P_LoadVertexes (lumpnum+ML_VERTEXES);
     P_LoadSectors (lumpnum+ML_SECTORS);
     P_LoadSideDefs (lumpnum+ML_SIDEDEFS);
 
+    // [JN] Sectors and sides are known, prefetch their flats and textures.
+    R_PrefetchLevel ();
+
     P_LoadLineDefs (lumpnum+ML_LINEDEFS);
     P_LoadSubsectors (lumpnum+ML_SSECTORS);
     P_LoadNodes (lumpnum+ML_NODES);
     P_LoadSegs (lumpnum+ML_SEGS);
+    P_InitSightStack ();
 
     P_GroupLines ();
+    P_InitSoundPortals ();
     P_LoadReject (lumpnum+ML_REJECT);
 
     bodyqueslot = 0;
@@ -1091,6 +1110,9 @@ P_SetupLevel
     if (precache)
 	R_PrecacheLevel ();
 
+    // [JN] Build wall texture composites before the first frame.
+    R_WarmComposites ();
+
     // [JN] Set level name.
     P_LevelNameInit();
 
@@ -21,6 +21,8 @@
 
 #include "doomstat.h"
 #include "i_system.h"
+#include "m_bbox.h"
+#include "z_zone.h"
 #include "p_local.h"
 
 
@@ -37,6 +39,16 @@ fixed_t		t2y;
 
 int		sightcounts[2];
 
+// [JN] Per-tic sight statistics: REJECT hits, BSP traversals and
+// nodes visited during the last game tic.
+int		sightstats[NUMSIGHTSTATS];
+static int	sightcurrent[NUMSIGHTSTATS];
+
+// [JN] Bounding boxes of the linedef endpoints referenced by each node
+// child, and an explicit stack of node children still to be crossed.
+static fixed_t	(*sightboxes)[2][4];
+static int*	sightstack;
+
 
 // PTR_SightTraverse() for Doom 1.2 sight calculations
 // taken from prboom-plus/src/p_sight.c:69-102
@@ -286,44 +298,199 @@ boolean P_CrossSubsector (int num)
 
 
 
+// -----------------------------------------------------------------------------
+// P_BuildSightBox
+//  [JN] Accumulates into box the endpoints of all linedefs that
+//  P_CrossSubsector may test below the given BSP child.
+// -----------------------------------------------------------------------------
+
+static void P_BuildSightBox (int bspnum, fixed_t *box)
+{
+    int side;
+
+    if (bspnum & NF_SUBSECTOR)
+    {
+        const subsector_t *sub;
+        const seg_t *seg;
+        int count;
+
+        sub = &subsectors[bspnum == -1 ? 0 : bspnum & ~NF_SUBSECTOR];
+        seg = &segs[sub->firstline];
+
+        for (count = sub->numlines ; count ; seg++, count--)
+        {
+            const line_t *line = seg->linedef;
+
+            box[BOXLEFT] = MIN(box[BOXLEFT], line->bbox[BOXLEFT]);
+            box[BOXRIGHT] = MAX(box[BOXRIGHT], line->bbox[BOXRIGHT]);
+            box[BOXBOTTOM] = MIN(box[BOXBOTTOM], line->bbox[BOXBOTTOM]);
+            box[BOXTOP] = MAX(box[BOXTOP], line->bbox[BOXTOP]);
+        }
+        return;
+    }
+
+    for (side = 0 ; side < 2 ; side++)
+    {
+        fixed_t *child = sightboxes[bspnum][side];
+
+        M_ClearBox(child);
+        P_BuildSightBox(nodes[bspnum].children[side], child);
+
+        box[BOXLEFT] = MIN(box[BOXLEFT], child[BOXLEFT]);
+        box[BOXRIGHT] = MAX(box[BOXRIGHT], child[BOXRIGHT]);
+        box[BOXBOTTOM] = MIN(box[BOXBOTTOM], child[BOXBOTTOM]);
+        box[BOXTOP] = MAX(box[BOXTOP], child[BOXTOP]);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// P_InitSightStack
+//  [JN] Called by P_SetupLevel once linedefs, nodes and segs are loaded.
+//  Every node pushes at most one child, so the stack never holds more
+//  than numnodes. Node bboxes cover segs only, while P_CrossSubsector
+//  tests whole linedefs, so the boxes used for pruning are rebuilt from
+//  linedef endpoints.
+// -----------------------------------------------------------------------------
+
+void P_InitSightStack (void)
+{
+    fixed_t box[4];
+
+    sightboxes = NULL;
+    sightstack = Z_Malloc((numnodes + 1) * sizeof(*sightstack), PU_LEVEL, 0);
+
+    if (numnodes > 0)
+    {
+        sightboxes = Z_Malloc(numnodes * sizeof(*sightboxes), PU_LEVEL, 0);
+        M_ClearBox(box);
+        P_BuildSightBox(numnodes - 1, box);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// P_SightTicker
+//  [JN] Publishes the sight statistics of the tic that has just been run.
+// -----------------------------------------------------------------------------
+
+void P_SightTicker (void)
+{
+    memcpy(sightstats, sightcurrent, sizeof(sightstats));
+    memset(sightcurrent, 0, sizeof(sightcurrent));
+}
+
+// -----------------------------------------------------------------------------
+// P_SightBoxMissed
+//  [JN] True if every corner of the box lies strictly on the same side of
+//  strace, as told by P_DivlineSide. Its truncated cross product only
+//  grows or shrinks along each axis, so every linedef endpoint inside the
+//  box is then on that side too, and P_CrossSubsector would reject all of
+//  those lines by "s1 == s2" anyway. Corners are checked in 64 bits as
+//  well, so a box is never skipped where the 32-bit differences or
+//  products would wrap around and break that ordering.
+// -----------------------------------------------------------------------------
+
+static boolean P_SightBoxMissed (const fixed_t *box)
+{
+    const fixed_t xs[2] = { box[BOXLEFT], box[BOXRIGHT] };
+    const fixed_t ys[2] = { box[BOXBOTTOM], box[BOXTOP] };
+    const int64_t ndx = strace.dx >> FRACBITS;
+    const int64_t ndy = strace.dy >> FRACBITS;
+    int first = -1;
+    int i;
+
+    // P_DivlineSide doesn't use the cross product for these.
+    if (!strace.dx || !strace.dy || box[BOXLEFT] > box[BOXRIGHT])
+    {
+        return false;
+    }
+
+    for (i = 0 ; i < 4 ; i++)
+    {
+        const int64_t dx = (int64_t) xs[i & 1] - strace.x;
+        const int64_t dy = (int64_t) ys[i >> 1] - strace.y;
+        int64_t left, right;
+        int side;
+
+        if (dx != (fixed_t) dx || dy != (fixed_t) dy)
+        {
+            return false;
+        }
+
+        left = ndy * (dx >> FRACBITS);
+        right = (dy >> FRACBITS) * ndx;
+
+        if (left != (fixed_t) left || right != (fixed_t) right)
+        {
+            return false;
+        }
+
+        side = right < left ? 0 : right > left ? 1 : 2;
+
+        if (side == 2 || (first != -1 && side != first))
+        {
+            return false;
+        }
+
+        first = side;
+    }
+
+    return true;
+}
+
 //
 // P_CrossBSPNode
 // Returns true
 //  if strace crosses the given node successfully.
 //
+// [JN] Walks the tree with an explicit stack instead of recursion.
+// The far side is pushed before descending into the near side, so
+// subsectors are crossed in exactly the original order. Children whose
+// linedefs all lie on one side of strace are skipped: none of them could
+// be crossed, and marking them with validcount makes no difference, as
+// the same test would reject them wherever else they are met.
+//
 boolean P_CrossBSPNode (int bspnum)
 {
     node_t*	bsp;
     int		side;
+    int		sp = 0;
 
-    if (bspnum & NF_SUBSECTOR)
+    for (;;)
     {
-	if (bspnum == -1)
-	    return P_CrossSubsector (0);
+	if (bspnum & NF_SUBSECTOR)
+	{
+	    if (!P_CrossSubsector (bspnum == -1 ? 0 : bspnum&(~NF_SUBSECTOR)))
+		return false;
+	}
 	else
-	    return P_CrossSubsector (bspnum&(~NF_SUBSECTOR));
-    }
-		
-    bsp = &nodes[bspnum];
-    
-    // decide which side the start point is on
-    side = P_DivlineSide (strace.x, strace.y, (divline_t *)bsp);
-    if (side == 2)
-	side = 0;	// an "on" should cross both sides
-
-    // cross the starting side
-    if (!P_CrossBSPNode (bsp->children[side]) )
-	return false;
-	
-    // the partition plane is crossed here
-    if (side == P_DivlineSide (t2x, t2y,(divline_t *)bsp))
-    {
-	// the line doesn't touch the other side
-	return true;
+	{
+	    sightcurrent[2]++;
+	    bsp = &nodes[bspnum];
+
+	    // decide which side the start point is on
+	    side = P_DivlineSide (strace.x, strace.y, (divline_t *)bsp);
+	    if (side == 2)
+		side = 0;	// an "on" should cross both sides
+
+	    // the partition plane is crossed here,
+	    // so the ending side is crossed after the starting one
+	    if (side != P_DivlineSide (t2x, t2y, (divline_t *)bsp)
+	    && !P_SightBoxMissed (sightboxes[bspnum][side^1]))
+		sightstack[sp++] = bsp->children[side^1];
+
+	    // cross the starting side
+	    if (!P_SightBoxMissed (sightboxes[bspnum][side]))
+	    {
+		bspnum = bsp->children[side];
+		continue;
+	    }
+	}
+
+	if (sp == 0)
+	    return true;
+
+	bspnum = sightstack[--sp];
     }
-    
-    // cross the ending side		
-    return P_CrossBSPNode (bsp->children[side^1]);
 }
 
 
@@ -357,6 +524,7 @@ P_CheckSight
     if (rejectmatrix[bytenum]&bitnum)
     {
 	sightcounts[0]++;
+	sightcurrent[0]++;
 
 	// can't possibly be connected
 	return false;	
@@ -365,6 +533,7 @@ P_CheckSight
     // An unobstructed LOS is possible.
     // Now look from eyes of t1 to any part of t2.
     sightcounts[1]++;
+    sightcurrent[1]++;
 
     validcount++;
 	
@@ -177,6 +177,44 @@ void P_InitPicAnims (void)
 	
 }
 
+// -----------------------------------------------------------------------------
+// P_MarkAnimatedTextures
+//  [JN] Marks all frames of every animated wall texture
+//  that has at least one of its frames marked in present[].
+// -----------------------------------------------------------------------------
+
+void P_MarkAnimatedTextures (char *present)
+{
+    anim_t *anim;
+    int i;
+
+    for (anim = anims ; anim < lastanim ; anim++)
+    {
+        if (!anim->istexture)
+        {
+            continue;
+        }
+
+        for (i = 0 ; i < anim->numpics ; i++)
+        {
+            if (present[anim->basepic + i])
+            {
+                break;
+            }
+        }
+
+        if (i == anim->numpics)
+        {
+            continue;
+        }
+
+        for (i = 0 ; i < anim->numpics ; i++)
+        {
+            present[anim->basepic + i] = 1;
+        }
+    }
+}
+
 
 
 //
@@ -1411,7 +1449,7 @@ int EV_DoDonut(line_t*	line)
             }
 
 	    //	Spawn rising slime
-	    floor = Z_Malloc (sizeof(*floor), PU_LEVSPEC, 0);
+	    floor = P_AllocThinker (sizeof(*floor));
 	    P_AddThinker (&floor->thinker);
 	    s2->specialdata = floor;
 	    floor->thinker.function.acp1 = (actionf_p1) T_MoveFloor;
@@ -1425,7 +1463,7 @@ int EV_DoDonut(line_t*	line)
 	    floor->floordestheight = s3_floorheight;
 	    
 	    //	Spawn lowering donut-hole
-	    floor = Z_Malloc (sizeof(*floor), PU_LEVSPEC, 0);
+	    floor = P_AllocThinker (sizeof(*floor));
 	    P_AddThinker (&floor->thinker);
 	    s1->specialdata = floor;
 	    floor->thinker.function.acp1 = (actionf_p1) T_MoveFloor;
@@ -20,6 +20,9 @@
 //
 
 
+#include <string.h>
+
+#include "i_system.h"
 #include "z_zone.h"
 #include "p_local.h"
 #include "doomstat.h"
@@ -37,12 +40,130 @@ int	leveltime;
 
 //
 // THINKERS
-// All thinkers should be allocated by Z_Malloc
+// All thinkers should be allocated by P_AllocThinker
 // so they can be operated on uniformly.
 // The actual structures will vary in size,
 // but the first element must be thinker_t.
 //
 
+// -----------------------------------------------------------------------------
+// Thinker pools
+// [JN] Thinkers of each size are carved out of PU_LEVEL slabs instead of
+// separate zone blocks. Fresh chunks are handed out in address order, so
+// the thinker list mostly walks memory sequentially. Freed chunks are only
+// recycled once the current slab is used up. Slabs are never freed one by
+// one, Z_FreeTags releases all of them on level exit.
+// -----------------------------------------------------------------------------
+
+#define MAXTHINKERPOOLS 16
+#define SLABSIZE        (64 * 1024)
+
+typedef struct thinkerpool_s thinkerpool_t;
+
+// Precedes every thinker in a slab. The payload itself is left untouched
+// when freed, as with Z_Free, in case something still looks at it.
+typedef struct poolchunk_s
+{
+    thinkerpool_t       *pool;
+    struct poolchunk_s  *next;  // Free list link.
+} poolchunk_t;
+
+struct thinkerpool_s
+{
+    size_t       size;       // Thinker size.
+    size_t       chunksize;  // Header plus thinker, aligned.
+    byte        *bump;       // Next never used chunk in current slab.
+    byte        *end;        // End of current slab.
+    poolchunk_t *freelist;
+};
+
+static thinkerpool_t thinkerpools[MAXTHINKERPOOLS];
+static int numthinkerpools;
+
+//
+// P_InitThinkerPools
+// Forgets all slabs, must be called after Z_FreeTags has released them.
+//
+void P_InitThinkerPools (void)
+{
+    memset(thinkerpools, 0, sizeof(thinkerpools));
+    numthinkerpools = 0;
+}
+
+static thinkerpool_t *P_ThinkerPool (size_t size)
+{
+    thinkerpool_t *pool;
+    int i;
+
+    for (i = 0 ; i < numthinkerpools ; i++)
+    {
+        if (thinkerpools[i].size == size)
+        {
+            return &thinkerpools[i];
+        }
+    }
+
+    if (numthinkerpools == MAXTHINKERPOOLS)
+    {
+        I_Error("P_ThinkerPool: too many thinker sizes");
+    }
+
+    pool = &thinkerpools[numthinkerpools++];
+    pool->size = size;
+    pool->chunksize = (sizeof(poolchunk_t) + size + 7) & ~(size_t) 7;
+
+    return pool;
+}
+
+//
+// P_AllocThinker
+// Returns uninitialized storage for a thinker of the given size,
+// valid until the level ends.
+//
+void *P_AllocThinker (size_t size)
+{
+    thinkerpool_t *pool = P_ThinkerPool(size);
+    poolchunk_t *chunk;
+
+    if (pool->bump + pool->chunksize <= pool->end)
+    {
+        chunk = (poolchunk_t *) pool->bump;
+        pool->bump += pool->chunksize;
+    }
+    else if (pool->freelist)
+    {
+        chunk = pool->freelist;
+        pool->freelist = chunk->next;
+    }
+    else
+    {
+        const size_t slabsize = MAX(SLABSIZE / pool->chunksize, 1) * pool->chunksize;
+
+        pool->bump = Z_Malloc(slabsize, PU_LEVEL, NULL);
+        pool->end = pool->bump + slabsize;
+        chunk = (poolchunk_t *) pool->bump;
+        pool->bump += pool->chunksize;
+    }
+
+    chunk->pool = pool;
+    chunk->next = NULL;
+
+    return chunk + 1;
+}
+
+//
+// P_FreeThinker
+// Returns a thinker allocated by P_AllocThinker to its pool.
+//
+void P_FreeThinker (thinker_t *thinker)
+{
+    poolchunk_t *chunk = (poolchunk_t *) thinker - 1;
+    thinkerpool_t *pool = chunk->pool;
+
+    chunk->next = pool->freelist;
+    pool->freelist = chunk;
+}
+
 
 
 // Both the head and tail of the thinker list.
@@ -124,7 +245,7 @@ void P_RunThinkers (void)
             nextthinker = currentthinker->next;
 	    currentthinker->next->prev = currentthinker->prev;
 	    currentthinker->prev->next = currentthinker->next;
-	    Z_Free(currentthinker);
+	    P_FreeThinker(currentthinker);
 	}
 	else
 	{
@@ -189,4 +310,6 @@ void P_Ticker (void)
     }
 
     realleveltime++;
+
+    P_SightTicker ();
 }
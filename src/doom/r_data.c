@@ -20,12 +20,18 @@
 //
 
 #include <stdio.h>
+#include <sys/stat.h>
 #include "deh_main.h"
 #include "i_swap.h"
 #include "i_system.h"
+#include "i_thread.h"
 #include "z_zone.h"
 #include "w_wad.h"
+#include "m_argv.h"
+#include "m_config.h"
 #include "m_misc.h"
+#include "sha1.h"
+#include "w_checksum.h"
 #include "p_local.h"
 #include "doomstat.h"
 #include "v_trans.h"
@@ -213,6 +219,57 @@ R_DrawColumnInCache
 
 
 
+//
+// R_DrawPatchInComposite
+// [JN] Draws the multi-patch columns covered by one patch of the
+// texture into its composite block. Touches nothing but the block,
+// so it is safe to call from worker threads.
+//
+static void
+R_DrawPatchInComposite
+( int		texnum,
+  texpatch_t*	patch,
+  patch_t*	realpatch,
+  byte*		block )
+{
+    texture_t*		texture;
+    int			x;
+    int			x1;
+    int			x2;
+    column_t*		patchcol;
+    short*		collump;
+    unsigned short*	colofs;
+
+    texture = textures[texnum];
+    collump = texturecolumnlump[texnum];
+    colofs = texturecolumnofs[texnum];
+
+    x1 = patch->originx;
+    x2 = x1 + SHORT(realpatch->width);
+
+    if (x1<0)
+	x = 0;
+    else
+	x = x1;
+	
+    if (x2 > texture->width)
+	x2 = texture->width;
+
+    for ( ; x<x2 ; x++)
+    {
+	// Column does not have multiple patches?
+	if (collump[x] >= 0)
+	    continue;
+	    
+	patchcol = (column_t *)((byte *)realpatch
+				+ LONG(realpatch->columnofs[x-x1]));
+	R_DrawColumnInCache (patchcol,
+			     block + colofs[x],
+			     patch->originy,
+			     texture->height);
+    }
+}
+
 //
 // R_GenerateComposite
 // Using the texture definition,
@@ -224,14 +281,7 @@ void R_GenerateComposite (int texnum)
     byte*		block;
     texture_t*		texture;
     texpatch_t*		patch;	
-    patch_t*		realpatch;
-    int			x;
-    int			x1;
-    int			x2;
     int			i;
-    column_t*		patchcol;
-    short*		collump;
-    unsigned short*	colofs;
 	
     texture = textures[texnum];
 
@@ -239,40 +289,14 @@ void R_GenerateComposite (int texnum)
 		      PU_STATIC, 
 		      &texturecomposite[texnum]);	
 
-    collump = texturecolumnlump[texnum];
-    colofs = texturecolumnofs[texnum];
-    
     // Composite the columns together.
     for (i=0 , patch = texture->patches;
 	 i<texture->patchcount;
 	 i++, patch++)
     {
-	realpatch = W_CacheLumpNum (patch->patch, PU_CACHE);
-	x1 = patch->originx;
-	x2 = x1 + SHORT(realpatch->width);
-
-	if (x1<0)
-	    x = 0;
-	else
-	    x = x1;
-	
-	if (x2 > texture->width)
-	    x2 = texture->width;
-
-	for ( ; x<x2 ; x++)
-	{
-	    // Column does not have multiple patches?
-	    if (collump[x] >= 0)
-		continue;
-	    
-	    patchcol = (column_t *)((byte *)realpatch
-				    + LONG(realpatch->columnofs[x-x1]));
-	    R_DrawColumnInCache (patchcol,
-				 block + colofs[x],
-				 patch->originy,
-				 texture->height);
-	}
-						
+	R_DrawPatchInComposite (texnum, patch,
+				W_CacheLumpNum (patch->patch, PU_CACHE),
+				block);
     }
 
     // Now that the texture has been built in column cache,
@@ -282,6 +306,11 @@ void R_GenerateComposite (int texnum)
 
 
 
+// [JN] Set when a texture is missing a patch. The data cache is not
+// written then, so the warning is shown on every startup, not only on
+// the one that built the cache.
+static boolean		lookupmissingpatch;
+
 //
 // R_GenerateLookup
 //
@@ -348,6 +377,7 @@ void R_GenerateLookup (int texnum)
         sprintf (badtexture, "\"%.8s\"", texture->name);
         CRL_printf(M_StringJoin("\nR_GenerateLookup: missing a patch in the texture ",
                    badtexture, NULL), false);
+        lookupmissingpatch = true;
 	    return;
 	}
 	// I_Error ("R_GenerateLookup: column without a patch");
@@ -441,6 +471,425 @@ static void GenerateTextureHashTable(void)
 }
 
 
+//
+// DERIVED DATA CACHE
+// [JN] Texture column lookups, sprite dimensions and the tint map only
+// depend on the loaded WADs, yet building them means reading every patch
+// and sprite lump. They are kept in a cache file in the config directory,
+// keyed by a SHA1 of the WAD directory, of the lumps that define them and
+// of the patch and sprite headers they are built from, and stored in the
+// same layout as the tables they are copied into.
+//
+
+#define DATACACHE_MAGIC     "CRLDATA"
+#define DATACACHE_VERSION   3
+#define DATACACHE_BYTEORDER 0x01020304
+
+typedef struct
+{
+    char		magic[8];
+    int			version;
+    int			byteorder;
+    sha1_digest_t	files;		// size and mtime of every WAD file
+    sha1_digest_t	key;
+    sha1_digest_t	sum;		// of everything after the header
+    int			numtextures;
+    int			numcolumns;	// sum of all texture widths
+    int			numspritelumps;
+} datacache_t;
+
+static sha1_digest_t	datacachefiles;
+static sha1_digest_t	datacachekey;
+static boolean		datacachekeyset;
+static char*		datacachefile;
+static byte*		datacache;	// valid cache contents, or NULL
+
+static int R_DataCacheLength (int textures, int columns, int spritelumps)
+{
+    return sizeof(datacache_t)
+	 + textures * sizeof(*texturecompositesize)
+	 + columns * (sizeof(**texturecolumnlump) + sizeof(**texturecolumnofs))
+	 + spritelumps * 3 * sizeof(*spritewidth)
+	 + 256 * 256;
+}
+
+static void R_HashLump (sha1_context_t *context, const char *name)
+{
+    int lump = W_CheckNumForName(name);
+
+    if (lump >= 0)
+    {
+	SHA1_Update(context, W_CacheLumpNum(lump, PU_STATIC),
+		    W_LumpLength(lump));
+	W_ReleaseLumpNum(lump);
+    }
+}
+
+//
+// R_HashLumpPart
+// Adds up to len bytes from the start of a lump, read without caching
+// the whole lump.
+//
+static void R_HashLumpPart (sha1_context_t *context, int lump, int len)
+{
+    const lumpinfo_t *l = lumpinfo[lump];
+    byte buf[1024];
+    int pos;
+
+    len = MIN(len, l->size);
+
+    for (pos = 0 ; pos < len ; pos += sizeof(buf))
+    {
+	const int n = MIN(len - pos, (int) sizeof(buf));
+
+	W_Read(l->wad_file, l->position + pos, buf, n);
+	SHA1_Update(context, buf, n);
+    }
+}
+
+//
+// R_HashPatchHeader
+// Adds what the cached tables take from a patch: the header and, for
+// wall patches, the column offsets.
+//
+static void R_HashPatchHeader (sha1_context_t *context, int lump,
+			       boolean columns)
+{
+    byte header[8];
+    int len = sizeof(header);
+
+    if (lumpinfo[lump]->size >= len)
+    {
+	W_Read(lumpinfo[lump]->wad_file, lumpinfo[lump]->position,
+	       header, len);
+
+	if (columns)
+	    len += SHORT(((patch_t *) header)->width) * 4;
+    }
+
+    R_HashLumpPart(context, lump, len);
+}
+
+//
+// R_DataCacheFiles
+// Cheap check of the cache against the loaded WADs: the path, size
+// and modification time of every WAD file.
+//
+static void R_DataCacheFiles (sha1_digest_t digest)
+{
+    sha1_context_t	context;
+    wad_file_t*		last = NULL;
+    struct stat		st;
+    unsigned int	i;
+
+    SHA1_Init(&context);
+
+    for (i=0 ; i<numlumps ; i++)
+    {
+	wad_file_t *wad = lumpinfo[i]->wad_file;
+
+	if (wad == last)
+	    continue;
+
+	last = wad;
+	SHA1_Update(&context, (byte *) wad->path, strlen(wad->path) + 1);
+
+	if (M_stat(wad->path, &st) == 0)
+	{
+	    SHA1_UpdateInt32(&context, (unsigned int) st.st_size);
+	    SHA1_UpdateInt32(&context, (unsigned int) st.st_mtime);
+	}
+    }
+
+    SHA1_Final(digest, &context);
+}
+
+//
+// R_DataCacheKey
+// SHA1 of everything the cached tables are built from: the WAD
+// directory, PLAYPAL, texture definitions and the headers of every
+// patch named by PNAMES and every sprite. Sprite offsets or patch
+// columns edited in place don't change the directory, but do change
+// this.
+//
+static void R_DataCacheKey (void)
+{
+    sha1_context_t	context;
+    sha1_digest_t	sum;
+    char		name[9];
+    byte*		names;
+    int			first, last;
+    int			nummappatches;
+    int			i;
+
+    if (datacachekeyset)
+	return;
+
+    W_Checksum(sum);
+    SHA1_Init(&context);
+    SHA1_Update(&context, sum, sizeof(sum));
+    R_HashLump(&context, "PLAYPAL");
+    R_HashLump(&context, DEH_String("PNAMES"));
+    R_HashLump(&context, DEH_String("TEXTURE1"));
+    R_HashLump(&context, DEH_String("TEXTURE2"));
+
+    // Wall patches, looked up the same way as by R_InitTextures.
+    names = W_CacheLumpName(DEH_String("PNAMES"), PU_STATIC);
+    nummappatches = LONG(*((int *) names));
+    name[8] = 0;
+
+    for (i=0 ; i<nummappatches ; i++)
+    {
+	int lump;
+
+	M_StringCopy(name, (const char *) names + 4 + i * 8, sizeof(name));
+	lump = W_CheckNumForName(name);
+
+	if (lump >= 0)
+	    R_HashPatchHeader(&context, lump, true);
+    }
+
+    W_ReleaseLumpName(DEH_String("PNAMES"));
+
+    // Sprites, as read by R_InitSpriteLumps.
+    first = W_CheckNumForName(DEH_String("S_START"));
+    last = W_CheckNumForName(DEH_String("S_END"));
+
+    for (i=first+1 ; first >= 0 && i<last ; i++)
+	R_HashPatchHeader(&context, i, false);
+
+    SHA1_Final(datacachekey, &context);
+    datacachekeyset = true;
+}
+
+//
+// R_LoadDataCache
+// Reads the cache file and checks it against the loaded WADs.
+// Table sizes are checked later, once they are known.
+//
+static void R_LoadDataCache (void)
+{
+    sha1_context_t	context;
+    sha1_digest_t	sum;
+    datacache_t*	header;
+    int			length;
+
+    datacache = NULL;
+
+    //!
+    // @category obscure
+    //
+    // Don't read or write the cache of texture, sprite and
+    // translucency tables built from the loaded WADs.
+    //
+
+    if (M_ParmExists("-nodatacache"))
+	return;
+
+    datacachefile = M_StringJoin(configdir, "crl-doom.cache", NULL);
+    datacachekeyset = false;
+    R_DataCacheFiles(datacachefiles);
+
+    if (!M_FileExists(datacachefile))
+	return;
+
+    length = M_ReadFile(datacachefile, &datacache);
+    header = (datacache_t *) datacache;
+
+    if (length < (int) sizeof(datacache_t)
+     || memcmp(header->magic, DATACACHE_MAGIC, sizeof(header->magic))
+     || header->version != DATACACHE_VERSION
+     || header->byteorder != DATACACHE_BYTEORDER
+     || memcmp(header->files, datacachefiles, sizeof(datacachefiles))
+     || length != R_DataCacheLength(header->numtextures, header->numcolumns,
+				    header->numspritelumps))
+    {
+	Z_Free(datacache);
+	datacache = NULL;
+	return;
+    }
+
+    // WAD files look the same, now check what is inside of them.
+    R_DataCacheKey();
+
+    if (memcmp(header->key, datacachekey, sizeof(datacachekey)))
+    {
+	Z_Free(datacache);
+	datacache = NULL;
+	return;
+    }
+
+    SHA1_Init(&context);
+    SHA1_Update(&context, datacache + sizeof(datacache_t),
+		length - sizeof(datacache_t));
+    SHA1_Final(sum, &context);
+
+    if (memcmp(header->sum, sum, sizeof(sum)))
+    {
+	Z_Free(datacache);
+	datacache = NULL;
+    }
+}
+
+//
+// R_DataCacheTables
+// Returns pointers to the tables stored after the header of a cache.
+//
+static void
+R_DataCacheTables
+( byte*		cache,
+  byte**	composite,
+  byte**	collump,
+  byte**	colofs,
+  byte**	sprites,
+  byte**	tint )
+{
+    const datacache_t *header = (datacache_t *) cache;
+
+    *composite = cache + sizeof(datacache_t);
+    *collump = *composite + header->numtextures * sizeof(*texturecompositesize);
+    *colofs = *collump + header->numcolumns * sizeof(**texturecolumnlump);
+    *sprites = *colofs + header->numcolumns * sizeof(**texturecolumnofs);
+    *tint = *sprites + header->numspritelumps * 3 * sizeof(*spritewidth);
+}
+
+//
+// R_ReadCachedLookups
+// Fills in what R_GenerateLookup would for every texture.
+// Returns false if there is no cache, or it doesn't match the textures.
+//
+static boolean R_ReadCachedLookups (void)
+{
+    byte*	composite;
+    byte*	collump;
+    byte*	colofs;
+    byte*	sprites;
+    byte*	tint;
+    int		columns;
+    int		i;
+
+    if (!datacache)
+	return false;
+
+    for (i=0, columns=0 ; i<numtextures ; i++)
+	columns += textures[i]->width;
+
+    if (((datacache_t *) datacache)->numtextures != numtextures
+     || ((datacache_t *) datacache)->numcolumns != columns)
+    {
+	Z_Free(datacache);
+	datacache = NULL;
+	return false;
+    }
+
+    R_DataCacheTables(datacache, &composite, &collump, &colofs,
+		      &sprites, &tint);
+
+    memcpy(texturecompositesize, composite,
+	   numtextures * sizeof(*texturecompositesize));
+
+    for (i=0 ; i<numtextures ; i++)
+    {
+	const int width = textures[i]->width;
+
+	texturecomposite[i] = 0;
+	memcpy(texturecolumnlump[i], collump,
+	       width * sizeof(**texturecolumnlump));
+	memcpy(texturecolumnofs[i], colofs,
+	       width * sizeof(**texturecolumnofs));
+	collump += width * sizeof(**texturecolumnlump);
+	colofs += width * sizeof(**texturecolumnofs);
+    }
+
+    return true;
+}
+
+//
+// R_SaveDataCache
+// Called at the end of R_InitData, writes the cache if it wasn't used.
+//
+static void R_SaveDataCache (void)
+{
+    sha1_context_t	context;
+    datacache_t*	header;
+    byte*		cache;
+    byte*		composite;
+    byte*		collump;
+    byte*		colofs;
+    byte*		sprites;
+    byte*		tint;
+    int			columns;
+    int			length;
+    int			i;
+
+    if (datacachefile == NULL)
+	return;
+
+    if (datacache)
+    {
+	Z_Free(datacache);
+	datacache = NULL;
+	return;
+    }
+
+    // Keep warning about broken textures until they are fixed.
+    if (lookupmissingpatch)
+	return;
+
+    for (i=0, columns=0 ; i<numtextures ; i++)
+	columns += textures[i]->width;
+
+    R_DataCacheKey();
+
+    length = R_DataCacheLength(numtextures, columns, numspritelumps);
+    cache = Z_Malloc(length, PU_STATIC, NULL);
+    header = (datacache_t *) cache;
+
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, DATACACHE_MAGIC, sizeof(header->magic));
+    header->version = DATACACHE_VERSION;
+    header->byteorder = DATACACHE_BYTEORDER;
+    memcpy(header->files, datacachefiles, sizeof(datacachefiles));
+    memcpy(header->key, datacachekey, sizeof(datacachekey));
+    header->numtextures = numtextures;
+    header->numcolumns = columns;
+    header->numspritelumps = numspritelumps;
+
+    R_DataCacheTables(cache, &composite, &collump, &colofs,
+		      &sprites, &tint);
+
+    memcpy(composite, texturecompositesize,
+	   numtextures * sizeof(*texturecompositesize));
+
+    for (i=0 ; i<numtextures ; i++)
+    {
+	const int width = textures[i]->width;
+
+	memcpy(collump, texturecolumnlump[i],
+	       width * sizeof(**texturecolumnlump));
+	memcpy(colofs, texturecolumnofs[i],
+	       width * sizeof(**texturecolumnofs));
+	collump += width * sizeof(**texturecolumnlump);
+	colofs += width * sizeof(**texturecolumnofs);
+    }
+
+    length = numspritelumps * sizeof(*spritewidth);
+    memcpy(sprites, spritewidth, length);
+    memcpy(sprites + length, spriteoffset, length);
+    memcpy(sprites + 2 * length, spritetopoffset, length);
+    memcpy(tint, tintmap, 256 * 256);
+
+    length = R_DataCacheLength(numtextures, columns, numspritelumps);
+    SHA1_Init(&context);
+    SHA1_Update(&context, cache + sizeof(datacache_t),
+		length - sizeof(datacache_t));
+    SHA1_Final(header->sum, &context);
+
+    M_WriteFile(datacachefile, cache, length);
+    Z_Free(cache);
+}
+
+
 //
 // R_InitTextures
 // Initializes the texture list
@@ -581,9 +1030,13 @@ void R_InitTextures (void)
         W_ReleaseLumpName(DEH_String("TEXTURE2"));
     
     // Precalculate whatever possible.	
+    // [JN] Unless it has already been done and cached.
 
-    for (i=0 ; i<numtextures ; i++)
-	R_GenerateLookup (i);
+    if (!R_ReadCachedLookups())
+    {
+	for (i=0 ; i<numtextures ; i++)
+	    R_GenerateLookup (i);
+    }
     
     // Create translation table for global animation.
     texturetranslation = Z_Malloc ((numtextures+1)*sizeof(*texturetranslation), PU_STATIC, 0);
@@ -633,6 +1086,26 @@ void R_InitSpriteLumps (void)
     spritewidth = Z_Malloc (numspritelumps*sizeof(*spritewidth), PU_STATIC, 0);
     spriteoffset = Z_Malloc (numspritelumps*sizeof(*spriteoffset), PU_STATIC, 0);
     spritetopoffset = Z_Malloc (numspritelumps*sizeof(*spritetopoffset), PU_STATIC, 0);
+
+    // [JN] Take sprite dimensions from the data cache, if it matches.
+    if (datacache && ((datacache_t *) datacache)->numspritelumps != numspritelumps)
+    {
+	Z_Free(datacache);
+	datacache = NULL;
+    }
+
+    if (datacache)
+    {
+	byte *composite, *collump, *colofs, *sprites, *tint;
+	const int length = numspritelumps * sizeof(*spritewidth);
+
+	R_DataCacheTables(datacache, &composite, &collump, &colofs,
+			  &sprites, &tint);
+	memcpy(spritewidth, sprites, length);
+	memcpy(spriteoffset, sprites + length, length);
+	memcpy(spritetopoffset, sprites + 2 * length, length);
+	return;
+    }
 	
     for (i=0 ; i< numspritelumps ; i++)
     {
@@ -708,6 +1181,16 @@ static void R_InitTintMap (void)
 
     tintmap = Z_Malloc(256*256, PU_STATIC, 0);
 
+    // [JN] Take the map from the data cache, if there is one.
+    if (datacache)
+    {
+        byte *composite, *collump, *colofs, *sprites, *tint;
+
+        R_DataCacheTables(datacache, &composite, &collump, &colofs,
+                          &sprites, &tint);
+        memcpy(tintmap, tint, 256*256);
+    }
+    else
     {
         byte *fg, *bg, blend[3];
         byte *tm = tintmap;
@@ -748,6 +1231,7 @@ static void R_InitTintMap (void)
 //
 void R_InitData (void)
 {
+    R_LoadDataCache ();
     R_InitTextures ();
     printf (".");
     R_InitFlats ();
@@ -757,6 +1241,55 @@ void R_InitData (void)
     R_InitColormaps ();
     
     R_InitTintMap ();
+    R_SaveDataCache ();
+}
+
+
+
+//
+// R_ReloadData
+// [JN] Called by P_SetupLevel when W_Reload reports changed resource
+// lumps. Frees the texture, flat and sprite lump tables and builds them
+// again from the new WAD directory.
+//
+void R_ReloadData (void)
+{
+    int		i;
+    char	skyname[9];
+
+    // Texture numbers may change, keep the sky by its name.
+    M_StringCopy(skyname, "", sizeof(skyname));
+    strncat(skyname, textures[skytexture]->name, 8);
+
+    for (i=0 ; i<numtextures ; i++)
+    {
+	if (texturecomposite[i])
+	    Z_Free(texturecomposite[i]);
+	Z_Free(texturecolumnlump[i]);
+	Z_Free(texturecolumnofs[i]);
+	Z_Free(textures[i]);
+    }
+
+    Z_Free(textures);
+    Z_Free(textures_hashtable);
+    Z_Free(texturecolumnlump);
+    Z_Free(texturecolumnofs);
+    Z_Free(texturecomposite);
+    Z_Free(texturecompositesize);
+    Z_Free(texturewidthmask);
+    Z_Free(textureheight);
+    Z_Free(texturetranslation);
+    Z_Free(flattranslation);
+    Z_Free(spritewidth);
+    Z_Free(spriteoffset);
+    Z_Free(spritetopoffset);
+
+    R_InitTextures ();
+    R_InitFlats ();
+    R_InitSpriteLumps ();
+    R_ReloadSprites ();
+
+    skytexture = R_TextureNumForName(skyname);
 }
 
 
@@ -837,6 +1370,176 @@ int R_TextureNumForName(const char *name)
 
 
 
+//
+// R_PrefetchLevel
+// [JN] Hints the flats and wall patches used by the level to the
+// memory-mapped WAD backend, so they are read in the background.
+//
+
+void R_PrefetchLevel (void)
+{
+    char*		flatpresent;
+    char*		texturepresent;
+    int			i;
+    int			j;
+    texture_t*		texture;
+
+    flatpresent = Z_Malloc(numflats, PU_STATIC, NULL);
+    memset (flatpresent,0,numflats);
+
+    for (i=0 ; i<numsectors ; i++)
+    {
+	flatpresent[sectors[i].floorpic] = 1;
+	flatpresent[sectors[i].ceilingpic] = 1;
+    }
+
+    for (i=0 ; i<numflats ; i++)
+    {
+	if (flatpresent[i])
+	    W_PrefetchLumpNum(firstflat + i);
+    }
+
+    Z_Free(flatpresent);
+
+    texturepresent = Z_Malloc(numtextures, PU_STATIC, NULL);
+    memset (texturepresent,0,numtextures);
+
+    for (i=0 ; i<numsides ; i++)
+    {
+	texturepresent[sides[i].toptexture] = 1;
+	texturepresent[sides[i].midtexture] = 1;
+	texturepresent[sides[i].bottomtexture] = 1;
+    }
+
+    texturepresent[skytexture] = 1;
+
+    for (i=0 ; i<numtextures ; i++)
+    {
+	if (!texturepresent[i])
+	    continue;
+
+	texture = textures[i];
+
+	for (j=0 ; j<texture->patchcount ; j++)
+	    W_PrefetchLumpNum(texture->patches[j].patch);
+    }
+
+    Z_Free(texturepresent);
+}
+
+//
+// R_WarmComposites
+// [JN] Builds the composites of every multi-patch texture the level can
+// show, including animation frames and switch states, using worker
+// threads. They are kept as PU_LEVEL, so PU_CACHE purges can't throw
+// them away before the level ends. Unlike R_PrecacheLevel, this is done
+// in demo playback too, so timedemo results don't include compositing.
+//
+
+static int*		warmtextures;
+static int		numwarmtextures;
+static patch_t**	warmpatches;
+
+static void R_WarmCompositesJob (int job, int numjobs)
+{
+    int			i;
+    int			j;
+    int			texnum;
+    texture_t*		texture;
+
+    for (i=job ; i<numwarmtextures ; i+=numjobs)
+    {
+	texnum = warmtextures[i];
+	texture = textures[texnum];
+
+	for (j=0 ; j<texture->patchcount ; j++)
+	{
+	    R_DrawPatchInComposite (texnum, &texture->patches[j],
+				    warmpatches[texture->patches[j].patch],
+				    texturecomposite[texnum]);
+	}
+    }
+}
+
+void R_WarmComposites (void)
+{
+    char*		texturepresent;
+    int			i;
+    int			j;
+    int			lump;
+    texture_t*		texture;
+
+    texturepresent = Z_Malloc(numtextures, PU_STATIC, NULL);
+    memset (texturepresent,0,numtextures);
+
+    for (i=0 ; i<numsides ; i++)
+    {
+	texturepresent[sides[i].toptexture] = 1;
+	texturepresent[sides[i].midtexture] = 1;
+	texturepresent[sides[i].bottomtexture] = 1;
+    }
+
+    texturepresent[skytexture] = 1;
+
+    P_MarkAnimatedTextures (texturepresent);
+    P_MarkSwitchTextures (texturepresent);
+
+    // Allocate all composites up front; Z_Malloc can't be called from
+    // the workers. Composites left over from earlier frames are kept.
+    warmtextures = Z_Malloc(numtextures * sizeof(*warmtextures),
+			    PU_STATIC, NULL);
+    numwarmtextures = 0;
+
+    for (i=0 ; i<numtextures ; i++)
+    {
+	if (!texturepresent[i] || !texturecompositesize[i])
+	    continue;
+
+	if (texturecomposite[i])
+	{
+	    Z_ChangeTag (texturecomposite[i], PU_LEVEL);
+	    continue;
+	}
+
+	Z_Malloc (texturecompositesize[i], PU_STATIC, &texturecomposite[i]);
+	warmtextures[numwarmtextures++] = i;
+    }
+
+    Z_Free(texturepresent);
+
+    // Lock the patches in memory for as long as the workers need them.
+    warmpatches = Z_Malloc(numlumps * sizeof(*warmpatches), PU_STATIC, NULL);
+    memset (warmpatches,0,numlumps * sizeof(*warmpatches));
+
+    for (i=0 ; i<numwarmtextures ; i++)
+    {
+	texture = textures[warmtextures[i]];
+
+	for (j=0 ; j<texture->patchcount ; j++)
+	{
+	    lump = texture->patches[j].patch;
+
+	    if (!warmpatches[lump])
+		warmpatches[lump] = W_CacheLumpNum(lump, PU_STATIC);
+	}
+    }
+
+    if (numwarmtextures > 0)
+	I_RunWorkers(R_WarmCompositesJob, I_GetCPUCount());
+
+    for (i=0 ; i<numwarmtextures ; i++)
+	Z_ChangeTag (texturecomposite[warmtextures[i]], PU_LEVEL);
+
+    for (i=0 ; i<(int)numlumps ; i++)
+    {
+	if (warmpatches[i])
+	    W_ReleaseLumpNum(i);
+    }
+
+    Z_Free(warmpatches);
+    Z_Free(warmtextures);
+}
+
 //
 // R_PrecacheLevel
 // Preloads all relevant graphics for the level.
@@ -94,7 +94,7 @@ fixed_t			dc_texturemid;
 byte*			dc_source;		
 
 // RestlessRodent -- CRL
-visplane_t* dc_visplaneused = NULL;
+THREADLOCAL visplane_t* dc_visplaneused = NULL;
 
 //
 // A column is a vertical slice/span from a wall texture that,
@@ -133,16 +133,15 @@ void R_DrawColumn (void)
     fracstep = dc_iscale; 
     frac = dc_texturemid + (dc_yl-centery)*fracstep; 
 
+    // RestlessRodent -- Possibly mark visplane
+    if (dc_visplaneused != NULL)
+	CRL_MarkColumn(dc_visplaneused - visplanes, dest, count + 1);
+
     // Inner loop that does the actual texture mapping,
     //  e.g. a DDA-lile scaling.
     // This is as fast as it gets.
     do 
     {
-
-	// RestlessRodent -- Possibly mark visplane
-	if (dc_visplaneused != NULL)
-		CRL_MarkPixelP(CRLPlaneSurface, dc_visplaneused, dest);
-	
 	// Re-map color indices from wall texture column
 	//  using a lighting/special effects LUT.
 	*dest = dc_colormap[dc_source[(frac>>FRACBITS)&127]];
@@ -186,17 +185,16 @@ void R_DrawColumnLow (void)
     fracstep = dc_iscale; 
     frac = dc_texturemid + (dc_yl-centery)*fracstep;
     
+    // RestlessRodent -- Possibly mark visplane
+    if (dc_visplaneused != NULL)
+    {
+	CRL_MarkColumn(dc_visplaneused - visplanes, dest, count + 1);
+	CRL_MarkColumn(dc_visplaneused - visplanes, dest2, count + 1);
+    }
+
     do 
     {
 	// Hack. Does not work corretly.
-	
-	// RestlessRodent -- Possibly mark visplane
-	if (dc_visplaneused != NULL)
-	{
-		CRL_MarkPixelP(CRLPlaneSurface, dc_visplaneused, dest);
-		CRL_MarkPixelP(CRLPlaneSurface, dc_visplaneused, dest2);
-	}
-	
 	*dest2 = *dest = dc_colormap[dc_source[(frac>>FRACBITS)&127]];
 	dest += SCREENWIDTH;
 	dest2 += SCREENWIDTH;
@@ -544,19 +542,20 @@ void R_InitTranslationTables (void)
 // In consequence, flats are not stored by column (like walls),
 //  and the inner loop has to step in texture space u and v.
 //
-int			ds_y; 
-int			ds_x1; 
-int			ds_x2;
+// [JN] Span state is thread-local, so flats can be drawn by parallel jobs.
+THREADLOCAL int			ds_y; 
+THREADLOCAL int			ds_x1; 
+THREADLOCAL int			ds_x2;
 
-lighttable_t*		ds_colormap; 
+THREADLOCAL lighttable_t*	ds_colormap; 
 
-fixed_t			ds_xfrac; 
-fixed_t			ds_yfrac; 
-fixed_t			ds_xstep; 
-fixed_t			ds_ystep;
+THREADLOCAL fixed_t		ds_xfrac; 
+THREADLOCAL fixed_t		ds_yfrac; 
+THREADLOCAL fixed_t		ds_xstep; 
+THREADLOCAL fixed_t		ds_ystep;
 
 // start of a 64*64 tile image 
-byte*			ds_source;	
+THREADLOCAL byte*		ds_source;	
 
 
 //
@@ -595,6 +594,10 @@ void R_DrawSpan (void)
     // We do not check for zero spans here?
     count = ds_x2 - ds_x1;
 
+    // RestlessRodent -- Possibly mark visplane
+    if (dc_visplaneused != NULL)
+	CRL_MarkSpan(dc_visplaneused - visplanes, dest, count + 1);
+
     do
     {
 	// Calculate current texture index in u,v.
@@ -602,10 +605,6 @@ void R_DrawSpan (void)
         xtemp = (position >> 26);
         spot = xtemp | ytemp;
 
-		// RestlessRodent -- Possibly mark visplane
-		if (dc_visplaneused != NULL)
-			CRL_MarkPixelP(CRLPlaneSurface, dc_visplaneused, dest);
-
 	// Lookup pixel from flat texture tile,
 	//  re-index using light/colormap.
 	*dest++ = ds_colormap[ds_source[spot]];
@@ -650,6 +649,10 @@ void R_DrawSpanLow (void)
 
     dest = ylookup[ds_y] + columnofs[ds_x1];
 
+    // RestlessRodent -- Possibly mark visplane
+    if (dc_visplaneused != NULL)
+	CRL_MarkSpan(dc_visplaneused - visplanes, dest, (count + 1) * 2);
+
     do
     {
 	// Calculate current texture index in u,v.
@@ -657,19 +660,9 @@ void R_DrawSpanLow (void)
         xtemp = (position >> 26);
         spot = xtemp | ytemp;
 
-
-	// RestlessRodent -- Possibly mark visplane
-	if (dc_visplaneused != NULL)
-		CRL_MarkPixelP(CRLPlaneSurface, dc_visplaneused, dest);
-
 	// Lowres/blocky mode does it twice,
 	//  while scale is adjusted appropriately.
 	*dest++ = ds_colormap[ds_source[spot]];
-	
-	// RestlessRodent -- Possibly mark visplane
-	if (dc_visplaneused != NULL)
-		CRL_MarkPixelP(CRLPlaneSurface, dc_visplaneused, dest);
-	
 	*dest++ = ds_colormap[ds_source[spot]];
 
 	position += step;
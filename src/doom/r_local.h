@@ -382,7 +382,7 @@ typedef struct
 // Now what is a visplane, anyway?
 // 
 
-typedef struct
+typedef struct visplane_s
 {
     fixed_t height;
     int     picnum;
@@ -390,6 +390,9 @@ typedef struct
     int     minx;
     int     maxx;
 
+    // Next plane in R_FindPlane hash chain.
+    struct visplane_s *next;
+
     // Is a find plane.
     int     isfindplane;
 
@@ -530,7 +533,10 @@ extern int   R_CheckTextureNumForName (const char *name);
 extern int   R_FlatNumForName (const char *name);
 extern int   R_TextureNumForName (const char *name);
 extern void  R_InitData (void);
+extern void  R_ReloadData (void);
 extern void  R_PrecacheLevel (void);
+extern void  R_PrefetchLevel (void);
+extern void  R_WarmComposites (void);
 
 extern int   *texturecompositesize;
 extern byte **texturecomposite;
@@ -558,29 +564,29 @@ extern void R_SetFuzzPosTic (void);
 extern void R_VideoErase (unsigned ofs, int count);
 
 extern byte *dc_source;
-extern byte *ds_source;		
+extern THREADLOCAL byte *ds_source;
 extern byte *translationtables;
 extern byte *dc_translation;
 
 extern int dc_x;
 extern int dc_yl;
 extern int dc_yh;
-extern int ds_y;
-extern int ds_x1;
-extern int ds_x2;
+extern THREADLOCAL int ds_y;
+extern THREADLOCAL int ds_x1;
+extern THREADLOCAL int ds_x2;
 
 extern fixed_t dc_iscale;
 extern fixed_t dc_texturemid;
-extern fixed_t ds_xfrac;
-extern fixed_t ds_yfrac;
-extern fixed_t ds_xstep;
-extern fixed_t ds_ystep;
+extern THREADLOCAL fixed_t ds_xfrac;
+extern THREADLOCAL fixed_t ds_yfrac;
+extern THREADLOCAL fixed_t ds_xstep;
+extern THREADLOCAL fixed_t ds_ystep;
 
 extern lighttable_t *dc_colormap;
-extern lighttable_t *ds_colormap;
+extern THREADLOCAL lighttable_t *ds_colormap;
 
 // GhostlyDeath -- CRL
-extern visplane_t   *dc_visplaneused;
+extern THREADLOCAL visplane_t *dc_visplaneused;
 
 // -----------------------------------------------------------------------------
 // R_MAIN
@@ -746,6 +752,7 @@ extern void R_DrawMasked (void);
 extern void R_DrawMaskedColumn (column_t *column);
 extern void R_DrawSprites (void);
 extern void R_InitSprites (const char **namelist);
+extern void R_ReloadSprites (void);
 extern void R_SortVisSprites (void);
 
 extern vissprite_t  vissprites[MAXREALVISSPRITES];
@@ -894,7 +894,9 @@ void R_RenderPlayerView (player_t* player)
 	if (js == 0)
 	{
 		// Start frame
+		CRL_ProfStart(CRL_PROF_SETUP);
 		R_SetupFrame (player);
+		CRL_ProfStop(CRL_PROF_SETUP);
 		
 		// Clear the view buffer
 		// [JN] CRL - allow to choose HOM effect.
@@ -926,21 +928,29 @@ void R_RenderPlayerView (player_t* player)
 		}
 
 		// The head node is the last node output.
+		CRL_ProfStart(CRL_PROF_BSP);
 		R_RenderBSPNode (numnodes-1);
+		CRL_ProfStop(CRL_PROF_BSP);
 		
 		// Check for new console commands.
 		NetUpdate ();
 		
 		// RestlessRodent -- Draw Visplanes
+		CRL_ProfStart(CRL_PROF_PLANES);
 		R_DrawPlanes ();
+		CRL_ProfStop(CRL_PROF_PLANES);
+		CRL_ProfStart(CRL_PROF_VISPLANES);
 		CRL_DrawVisPlanes(0);
+		CRL_ProfStop(CRL_PROF_VISPLANES);
 		
 		// Check for new console commands.
 		NetUpdate ();
 		
 		// [crispy] draw fuzz effect independent of rendering frame rate
 		R_SetFuzzPosDraw();
+		CRL_ProfStart(CRL_PROF_MASKED);
 		R_DrawMasked ();
+		CRL_ProfStop(CRL_PROF_MASKED);
 
 		// Check for new console commands.
 		NetUpdate ();
@@ -25,6 +25,7 @@
 #include <stdlib.h>
 
 #include "i_system.h"
+#include "i_thread.h"
 #include "z_zone.h"
 #include "w_wad.h"
 
@@ -46,6 +47,15 @@ visplane_t*		lastvisplane;
 visplane_t*		floorplane;
 visplane_t*		ceilingplane;
 
+// Hash chains of visplanes by height, picnum and lightlevel. Only the
+// first plane of every kind is linked, so lookup returns the same plane
+// as the linear scan of vanilla R_FindPlane.
+#define MAXVISPLANEHASH 512
+#define visplane_hash(picnum,lightlevel,height) \
+    (((unsigned)(picnum)*3+(unsigned)(lightlevel)+(unsigned)(height)*7) & (MAXVISPLANEHASH-1))
+
+static visplane_t *visplanehash[MAXVISPLANEHASH];
+
 // ?
 // [JN] CRL - remove MAXOPENINGS limit enterily. 
 // Render limits level will still do actual drawing limit.
@@ -66,24 +76,35 @@ int  ceilingclip[SCREENWIDTH];  // [JN] 32-bit integer math
 // spanstart holds the start of a plane span
 // initialized to 0 at start
 //
-int			spanstart[SCREENHEIGHT];
+// [JN] Thread-local, as well as span caches and texture mapping
+// below, so flats can be drawn by parallel jobs.
+//
+THREADLOCAL int		spanstart[SCREENHEIGHT];
 int			spanstop[SCREENHEIGHT];
 
 //
 // texture mapping
 //
-lighttable_t**		planezlight;
-fixed_t			planeheight;
+THREADLOCAL lighttable_t**	planezlight;
+THREADLOCAL fixed_t		planeheight;
 
 fixed_t			yslope[SCREENHEIGHT];
 fixed_t			distscale[SCREENWIDTH];
 fixed_t			basexscale;
 fixed_t			baseyscale;
 
-fixed_t			cachedheight[SCREENHEIGHT];
-fixed_t			cacheddistance[SCREENHEIGHT];
-fixed_t			cachedxstep[SCREENHEIGHT];
-fixed_t			cachedystep[SCREENHEIGHT];
+THREADLOCAL fixed_t	cachedheight[SCREENHEIGHT];
+THREADLOCAL fixed_t	cacheddistance[SCREENHEIGHT];
+THREADLOCAL fixed_t	cachedxstep[SCREENHEIGHT];
+THREADLOCAL fixed_t	cachedystep[SCREENHEIGHT];
+
+// [JN] Parallel flat drawing: every job draws only the rows
+// where y % planejobs == planejob.
+static THREADLOCAL int	planejob;
+static THREADLOCAL int	planejobs = 1;
+
+// Flat data of every visplane, cached before running parallel jobs.
+static byte*		planesource[REALMAXVISPLANES];
 
 
 /**
@@ -168,6 +189,12 @@ R_MapPlane
     }
 #endif
 
+    // [JN] Row belongs to another parallel job.
+    if (planejobs > 1 && y % planejobs != planejob)
+    {
+	return;
+    }
+
     if (planeheight != cachedheight[y])
     {
 	cachedheight[y] = planeheight;
@@ -228,6 +255,7 @@ void R_ClearPlanes (void)
 
     lastvisplane = visplanes;
     lastopening = openings;
+    memset (visplanehash, 0, sizeof(visplanehash));
     
     // texture calculation
     memset (cachedheight, 0, sizeof(cachedheight));
@@ -253,6 +281,7 @@ R_FindPlane
   int		lightlevel, seg_t* __line, subsector_t* __sub)
 {
     visplane_t*	check;
+    unsigned	hash;
 	
     if (picnum == skyflatnum)
     {
@@ -260,19 +289,19 @@ R_FindPlane
 	lightlevel = 0;
     }
 	
-    for (check=visplanes; check<lastvisplane; check++)
+    hash = visplane_hash(picnum, lightlevel, height);
+
+    for (check=visplanehash[hash]; check; check=check->next)
     {
 	if (height == check->height
 	    && picnum == check->picnum
 	    && lightlevel == check->lightlevel)
 	{
-	    break;
+	    return check;
 	}
     }
     
-			
-    if (check < lastvisplane)
-	return check;
+    check = lastvisplane;
 		
     // [JN] Catch extreme overflows and prevent crash.
     if (lastvisplane - visplanes == REALMAXVISPLANES)
@@ -298,6 +327,9 @@ R_FindPlane
     check->emitsub = __sub;
     
     memset (check->top,0xff,sizeof(check->top));
+
+    check->next = visplanehash[hash];
+    visplanehash[hash] = check;
 		
     return check;
 }
@@ -421,6 +453,69 @@ R_MakeSpans
 
 
 
+//
+// R_DrawFlat
+// [JN] Draws regular flat visplane, using given flat data.
+//
+static void R_DrawFlat (visplane_t* pl, byte* source)
+{
+    int			light;
+    int			x;
+    int			stop;
+
+    ds_source = source;
+
+    planeheight = abs(pl->height-viewz);
+    light = (pl->lightlevel >> LIGHTSEGSHIFT)+extralight;
+
+    if (light >= LIGHTLEVELS)
+	light = LIGHTLEVELS-1;
+
+    if (light < 0)
+	light = 0;
+
+    planezlight = zlight[light];
+
+    stop = pl->maxx + 1;
+
+    for (x=pl->minx ; x<= stop ; x++)
+    {
+	R_MakeSpans(x,pl->top[x-1],
+		    pl->bottom[x-1],
+		    pl->top[x],
+		    pl->bottom[x], pl);
+    }
+}
+
+
+//
+// R_DrawPlanesJob
+// [JN] One of parallel jobs drawing regular flats. Every job walks all
+// the visplanes, but draws only its own rows, so no pixel is shared.
+//
+static void R_DrawPlanesJob (int job, int numjobs)
+{
+    visplane_t*		pl;
+
+    planejob = job;
+    planejobs = numjobs;
+
+    // Span caches of this thread may be left from previous frame.
+    memset (cachedheight, 0, sizeof(cachedheight));
+
+    for (pl = visplanes ; pl < lastvisplane ; pl++)
+    {
+	if (planesource[pl - visplanes] != NULL)
+	{
+	    R_DrawFlat(pl, planesource[pl - visplanes]);
+	}
+    }
+
+    planejob = 0;
+    planejobs = 1;
+}
+
+
 //
 // R_DrawPlanes
 // At the end of each frame.
@@ -428,12 +523,17 @@ R_MakeSpans
 void R_DrawPlanes (void)
 {
     visplane_t*		pl;
-    int			light;
     int			x;
-    int			stop;
     int			angle;
     int                 lumpnum;
     const int dsegs = ds_p - drawsegs;  // [JN] Shortcut.
+    // [JN] Draw flats by parallel jobs if asked. Visplane drawing mode
+    // needs to mark every span on shared surface, so it stays serial.
+#ifdef HAVE_THREADLOCAL
+    const boolean parallel = crl_plane_threads > 1 && !crl_visplanes_drawing;
+#else
+    const boolean parallel = false;
+#endif
 				
     // [JN] CRL - openings counter.
     CRLData.numopenings = lastopening - openings;
@@ -510,32 +610,33 @@ void R_DrawPlanes (void)
 	
 	// regular flat
         lumpnum = firstflat + flattranslation[pl->picnum];
-	ds_source = W_CacheLumpNum(lumpnum, PU_STATIC);
-	
-	planeheight = abs(pl->height-viewz);
-	light = (pl->lightlevel >> LIGHTSEGSHIFT)+extralight;
-
-	if (light >= LIGHTLEVELS)
-	    light = LIGHTLEVELS-1;
-
-	if (light < 0)
-	    light = 0;
-
-	planezlight = zlight[light];
 
 	pl->top[pl->maxx+1] = 0xffffu;
 	pl->top[pl->minx-1] = 0xffffu;
-		
-	stop = pl->maxx + 1;
 
-	for (x=pl->minx ; x<= stop ; x++)
+	// [JN] Keep flat cached until parallel jobs are done with it.
+	if (parallel)
 	{
-	    R_MakeSpans(x,pl->top[x-1],
-			pl->bottom[x-1],
-			pl->top[x],
-			pl->bottom[x], pl);
+	    planesource[pl - visplanes] = W_CacheLumpNum(lumpnum, PU_STATIC);
+	    continue;
 	}
+
+	R_DrawFlat(pl, W_CacheLumpNum(lumpnum, PU_STATIC));
 	
         W_ReleaseLumpNum(lumpnum);
     }
+
+    if (parallel)
+    {
+	I_RunWorkers(R_DrawPlanesJob, crl_plane_threads);
+
+	for (pl = visplanes ; pl < lastvisplane ; pl++)
+	{
+	    if (planesource[pl - visplanes] != NULL)
+	    {
+		W_ReleaseLumpNum(firstflat + flattranslation[pl->picnum]);
+		planesource[pl - visplanes] = NULL;
+	    }
+	}
+    }
 }
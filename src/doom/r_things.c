@@ -306,6 +306,29 @@ void R_InitSprites(const char **namelist)
 
 
 
+//
+// R_ReloadSprites
+// [JN] Builds the sprite frame tables again after the
+// sprite lumps have been reloaded by W_Reload.
+//
+void R_ReloadSprites (void)
+{
+    int		i;
+
+    for (i=0 ; i<numsprites ; i++)
+    {
+	if (sprites[i].numframes)
+	    Z_Free(sprites[i].spriteframes);
+    }
+
+    if (numsprites)
+	Z_Free(sprites);
+
+    R_InitSpriteDefs (sprnames);
+}
+
+
+
 //
 // R_ClearSprites
 // Called at frame start.
@@ -858,50 +881,56 @@ void R_SortVisSprites (void)
 {
     int			i;
     int			count;
-    vissprite_t*	ds;
-    vissprite_t*	best;
-    static vissprite_t	unsorted;
-    fixed_t		bestscale;
+    int			width;
+    int			lo, mid, hi;
+    int			l, r;
+    vissprite_t**	src;
+    vissprite_t**	dst;
+    vissprite_t**	swap;
+    static vissprite_t*	sortbuf[2][MAXREALVISSPRITES];
 
     count = vissprite_p - vissprites;
-	
-    unsorted.next = unsorted.prev = &unsorted;
 
     if (!count)
 	return;
-		
-    for (ds=vissprites ; ds<vissprite_p ; ds++)
-    {
-	ds->next = ds+1;
-	ds->prev = ds-1;
-    }
-    
-    vissprites[0].prev = &unsorted;
-    unsorted.next = &vissprites[0];
-    (vissprite_p-1)->next = &unsorted;
-    unsorted.prev = vissprite_p-1;
-    
-    // pull the vissprites out by scale
 
-    vsprsortedhead.next = vsprsortedhead.prev = &vsprsortedhead;
+    src = sortbuf[0];
+    dst = sortbuf[1];
+
     for (i=0 ; i<count ; i++)
+	src[i] = &vissprites[i];
+
+    // Bottom-up merge sort by scale. It is stable, so sprites of equal
+    // scale keep the order vanilla's repeated minimum selection gave them.
+    for (width=1 ; width<count ; width*=2)
     {
-	bestscale = INT_MAX;
-        best = unsorted.next;
-	for (ds=unsorted.next ; ds!= &unsorted ; ds=ds->next)
+	for (lo=0 ; lo<count ; lo+=width*2)
 	{
-	    if (ds->scale < bestscale)
+	    mid = MIN(lo+width, count);
+	    hi = MIN(lo+width*2, count);
+
+	    for (i=lo, l=lo, r=mid ; i<hi ; i++)
 	    {
-		bestscale = ds->scale;
-		best = ds;
+		if (l < mid && (r >= hi || src[l]->scale <= src[r]->scale))
+		    dst[i] = src[l++];
+		else
+		    dst[i] = src[r++];
 	    }
 	}
-	best->next->prev = best->prev;
-	best->prev->next = best->next;
-	best->next = &vsprsortedhead;
-	best->prev = vsprsortedhead.prev;
-	vsprsortedhead.prev->next = best;
-	vsprsortedhead.prev = best;
+
+	swap = src;
+	src = dst;
+	dst = swap;
+    }
+
+    // link them up, back to front
+    vsprsortedhead.next = vsprsortedhead.prev = &vsprsortedhead;
+    for (i=0 ; i<count ; i++)
+    {
+	src[i]->next = &vsprsortedhead;
+	src[i]->prev = vsprsortedhead.prev;
+	vsprsortedhead.prev->next = src[i];
+	vsprsortedhead.prev = src[i];
     }
 }
 
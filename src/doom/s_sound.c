@@ -108,8 +108,9 @@ static boolean mus_paused;
 
 static musicinfo_t *mus_playing = NULL;
 
-// [JN] Always allocate 8 SFX channels.
+// [JN] Always allocate as many SFX channels as the native mixer can play.
 // No memory reallocation will be needed upon changing of channels number.
+// Other sound modules are limited to 8 channels.
 
 #define MAX_SND_CHANNELS 8  
 
@@ -126,10 +127,14 @@ int crl_musicnum;
 //  allocates channel buffer, sets S_sfx lookup.
 //
 
-void S_Init(int sfxVolume, int musicVolume)
-{
-    int i;
+// -----------------------------------------------------------------------------
+// S_SetOPLDriverVer
+// [JN] Picks the OPL driver version of the emulated executable. Split out
+// of S_Init for -rendermusic, which runs before sound is set up.
+// -----------------------------------------------------------------------------
 
+void S_SetOPLDriverVer (void)
+{
     if (gameversion == exe_doom_1_666)
     {
         if (logical_gamemission == doom)
@@ -145,6 +150,13 @@ void S_Init(int sfxVolume, int musicVolume)
     {
         I_SetOPLDriverVer(opl_doom_1_9);
     }
+}
+
+void S_Init(int sfxVolume, int musicVolume)
+{
+    int i;
+
+    S_SetOPLDriverVer();
 
     I_PrecacheSounds(S_sfx, NUMSFX);
 
@@ -154,10 +166,11 @@ void S_Init(int sfxVolume, int musicVolume)
     // Allocating the internal channels for mixing
     // (the maximum numer of sounds rendered
     // simultaneously) within zone memory.
-    channels = Z_Malloc(MAX_SND_CHANNELS*sizeof(channel_t), PU_STATIC, 0);
+    channels = Z_Malloc(MAX_MIX_VOICES*sizeof(channel_t), PU_STATIC, 0);
+    S_LimitChannels();
 
     // Free all channels for use
-    for (i=0 ; i<MAX_SND_CHANNELS ; i++)
+    for (i=0 ; i<MAX_MIX_VOICES ; i++)
     {
         channels[i].sfxinfo = 0;
     }
@@ -183,6 +196,24 @@ void S_Init(int sfxVolume, int musicVolume)
     S_UpdateStereoSeparation();
 }
 
+// -----------------------------------------------------------------------------
+// S_LimitChannels
+// [JN] Keeps snd_channels within what the active sound module can play.
+// Called once the sound module has been set up.
+// -----------------------------------------------------------------------------
+
+void S_LimitChannels (void)
+{
+    const int limit = I_NativeMixerActive() ? MAX_MIX_VOICES : MAX_SND_CHANNELS;
+
+    if (snd_channels > limit)
+    {
+        fprintf(stderr, "S_LimitChannels: snd_channels %d is above the "
+                        "limit of %d, lowering.\n", snd_channels, limit);
+        snd_channels = limit;
+    }
+}
+
 // -----------------------------------------------------------------------------
 // S_ChangeSFXSystem
 // [JN] Routine for sfx device hot-swapping.
@@ -193,7 +224,7 @@ void S_ChangeSFXSystem (void)
     int i;
 
     // Free all channels for use
-    for (i = 0 ; i < MAX_SND_CHANNELS ; i++)
+    for (i = 0 ; i < MAX_MIX_VOICES ; i++)
     {
         channels[i].sfxinfo = 0;
     }
@@ -85,6 +85,8 @@ void S_UpdateSounds(mobj_t *listener);
 void S_SetMusicVolume(int volume);
 void S_SetSfxVolume(int volume);
 
+extern void S_LimitChannels (void);
+extern void S_SetOPLDriverVer (void);
 extern void S_ChangeSFXSystem (void);
 extern void S_UpdateStereoSeparation (void);
 
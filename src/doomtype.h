@@ -92,6 +92,19 @@
 
 #define PACKED_STRUCT(...) PACKEDPREFIX struct __VA_ARGS__ PACKEDATTR
 
+// Thread-local storage class, used for drawing state of renderer
+// that is shared between parallel drawing jobs.
+
+#if defined(_MSC_VER)
+#define THREADLOCAL __declspec(thread)
+#define HAVE_THREADLOCAL
+#elif defined(__GNUC__)
+#define THREADLOCAL __thread
+#define HAVE_THREADLOCAL
+#else
+#define THREADLOCAL
+#endif
+
 // C99 integer types; with gcc we just use this.  Other compilers
 // should add conditional statements that define the C99 types.
 
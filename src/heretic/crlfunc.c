@@ -489,6 +489,22 @@ void CRL_DrawFPS (void)
                                      - MN_TextAWidth(fps_str), yy, cr[CR_GRAY]);
 
     MN_DrTextA(fps_str, SCREENWIDTH - 7 - MN_TextAWidth(fps_str), yy, cr[CR_GRAY]);
+
+    // [JN] Render profiler: average time of every phase in milliseconds.
+    if (crl_showfps == 2)
+    {
+        char str[32];
+        int  i;
+
+        for (i = 0 ; i < CRL_NUMPROFS ; i++)
+        {
+            yy += 10;
+            M_snprintf(str, sizeof(str), "%s %d.%02d", CRL_ProfNames[i],
+                       CRL_ProfTimes[i] / 1000, CRL_ProfTimes[i] % 1000 / 10);
+            MN_DrTextA(str, SCREENWIDTH - 7 - MN_TextAWidth(str), yy,
+                       cr[CR_GRAY]);
+        }
+    }
 }
 
 
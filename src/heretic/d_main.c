@@ -218,14 +218,20 @@ void D_Display(void)
 
             if (automapactive)
             {
+                CRL_ProfStart(CRL_PROF_AUTOMAP);
                 AM_Drawer();
+                CRL_ProfStop(CRL_PROF_AUTOMAP);
             }
             else
             {
                 // [JN] RestlessRodent -- draw visplanes if overlayed
+                CRL_ProfStart(CRL_PROF_VISPLANES);
                 CRL_DrawVisPlanes(1);
+                CRL_ProfStop(CRL_PROF_VISPLANES);
             }
 
+            CRL_ProfStart(CRL_PROF_HUD);
+
             if (crl_extended_hud)
             {
                 // [JN] CRL Stats
@@ -267,6 +273,7 @@ void D_Display(void)
                 }
             }
 
+            CRL_ProfStop(CRL_PROF_HUD);
             break;
         case GS_INTERMISSION:
             IN_Drawer();
@@ -297,6 +304,7 @@ void D_Display(void)
         }
     }
     // Menu drawing
+    CRL_ProfStart(CRL_PROF_HUD);
     MN_Drawer();
 
     // Handle player messages
@@ -304,12 +312,16 @@ void D_Display(void)
 
     // [JN] Critical messages are drawn even higher than on top everything!
     CRL_DrawMessageCritical();
+    CRL_ProfStop(CRL_PROF_HUD);
 
     // Send out any new accumulation
     NetUpdate();
 
     // Flush buffered stuff to screen
+    CRL_ProfStart(CRL_PROF_PRESENT);
     I_FinishUpdate();
+    CRL_ProfStop(CRL_PROF_PRESENT);
+    CRL_ProfFrame();
 }
 
 //
@@ -375,7 +387,12 @@ void D_DoomLoop(void)
             S_UpdateSounds(players[consoleplayer].mo);
             oldgametic = gametic;
         }
-        D_Display();
+
+        // [JN] Skip drawing if framerate limiter says it's too early.
+        if (I_FrameDue())
+        {
+            D_Display();
+        }
     }
 }
 
@@ -1296,6 +1313,7 @@ void D_DoomMain(void)
     p = M_CheckParmWithArgs("-timedemo", 1);
     if (p)
     {
+        CRL_BenchStart(myargv[p + 1]);
         G_TimeDemo(demolumpname);
         D_DoomLoop();           // Never returns
     }
@@ -1065,6 +1065,16 @@ void G_DoLoadLevel(void)
     }
 
     P_SetupLevel(gameepisode, gamemap, 0, gameskill);
+
+    // [JN] Start new map section of timedemo report.
+    if (timingdemo)
+    {
+        char name[9];
+
+        M_snprintf(name, sizeof(name), "E%dM%d", gameepisode, gamemap);
+        CRL_BenchMap(name, gametic);
+    }
+
     // [JN] Do not reset chosen player view across levels in multiplayer
     // demo playback. However, it must be reset when starting a new game.
     if (usergame)
@@ -2796,6 +2806,8 @@ boolean G_CheckDemoStatus(void)
         endtime = I_GetTime();
         realtics = endtime - starttime;
         fps = ((float) gametic * TICRATE) / realtics;
+        // [JN] Print frame time statistics and write JSON report.
+        CRL_BenchReport(gametic, realtics);
         I_Error("timed %i gametics in %i realtics (%f fps)",
                 gametic, realtics, fps);
     }
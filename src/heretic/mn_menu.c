@@ -1071,7 +1071,8 @@ static void DrawCRLVideo (void)
                M_Item_Glow(2, crl_vsync ? GLOW_GREEN : GLOW_RED));
 
     // Show FPS counter
-    sprintf(str, crl_showfps ? "ON" : "OFF");
+    sprintf(str, crl_showfps == 1 ? "ON" :
+                 crl_showfps == 2 ? "PROFILE" : "OFF");
     MN_DrTextA(str, M_ItemRightAlign(str), 50,
                M_Item_Glow(3, crl_showfps ? GLOW_GREEN : GLOW_RED));
 
@@ -1178,7 +1179,7 @@ static void CRL_VSync (int option)
 
 static void CRL_ShowFPS (int option)
 {
-    crl_showfps ^= 1;
+    crl_showfps = M_INT_Slider(crl_showfps, 0, 2, option, false);
 }
 
 static void CRL_PixelScaling (int choice)
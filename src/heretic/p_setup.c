@@ -610,12 +610,21 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
 
     lumpnum = W_GetNumForName(lumpname);
 
+    // [JN] Let mapped WADs read the level lumps in the background.
+    for (i = ML_THINGS; i <= ML_BLOCKMAP; i++)
+    {
+        W_PrefetchLumpNum(lumpnum + i);
+    }
+
 // note: most of this ordering is important     
     P_LoadBlockMap(lumpnum + ML_BLOCKMAP);
     P_LoadVertexes(lumpnum + ML_VERTEXES);
     P_LoadSectors(lumpnum + ML_SECTORS);
     P_LoadSideDefs(lumpnum + ML_SIDEDEFS);
 
+    // [JN] Sectors and sides are known, prefetch their flats and textures.
+    R_PrefetchLevel();
+
     P_LoadLineDefs(lumpnum + ML_LINEDEFS);
     P_LoadSubsectors(lumpnum + ML_SSECTORS);
     P_LoadNodes(lumpnum + ML_NODES);
@@ -675,6 +684,9 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
     if (precache)
         R_PrecacheLevel();
 
+    // [JN] Build wall texture composites before the first frame.
+    R_WarmComposites();
+
     // [JN] Check if MAX visplanes should be cleared.
     // If level is same, keep MAX value. Otherwise, reset it.
     {
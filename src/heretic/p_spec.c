@@ -300,6 +300,37 @@ void P_InitPicAnims(void)
     }
 }
 
+//----------------------------------------------------------------------------
+//
+// PROC P_MarkAnimatedTextures
+//
+// [JN] Marks all frames of every animated wall texture
+// that has at least one of its frames marked in present[].
+//
+//----------------------------------------------------------------------------
+
+void P_MarkAnimatedTextures(char *present)
+{
+    anim_t *anim;
+    int i;
+
+    for (anim = anims; anim < lastanim; anim++)
+    {
+        if (!anim->istexture)
+            continue;
+
+        for (i = 0; i < anim->numpics; i++)
+            if (present[anim->basepic + i])
+                break;
+
+        if (i == anim->numpics)
+            continue;
+
+        for (i = 0; i < anim->numpics; i++)
+            present[anim->basepic + i] = 1;
+    }
+}
+
 /*
 ==============================================================================
 
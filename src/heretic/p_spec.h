@@ -68,6 +68,7 @@ extern line_t *linespeciallist[MAXLINEANIMS];
 
 // at game start
 void P_InitPicAnims(void);
+void P_MarkAnimatedTextures(char *present);
 void P_InitTerrainTypes(void);
 void P_InitLava(void);
 
@@ -195,6 +196,7 @@ extern button_t buttonlist[MAXBUTTONS];
 
 void P_ChangeSwitchTexture(line_t * line, int useAgain);
 void P_InitSwitchList(void);
+void P_MarkSwitchTextures(char *present);
 
 /*
 ===============================================================================
@@ -134,6 +134,25 @@ void P_InitSwitchList(void)
     switchlist[slindex] = -1;
 }
 
+/*
+===============
+=
+= P_MarkSwitchTextures
+=
+= [JN] Marks the other state of every switch texture marked in present[]
+=
+===============
+*/
+
+void P_MarkSwitchTextures(char *present)
+{
+    int i;
+
+    for (i = 0; i < numswitches * 2; i++)
+        if (present[switchlist[i]])
+            present[switchlist[i ^ 1]] = 1;
+}
+
 //==================================================================
 //
 //      Start a button counting down till it turns off.
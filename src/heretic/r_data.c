@@ -23,6 +23,7 @@
 
 #include "i_swap.h"
 #include "i_system.h"
+#include "i_thread.h"
 #include "m_misc.h"
 #include "r_local.h"
 #include "p_local.h"
@@ -129,6 +130,52 @@ void R_DrawColumnInCache(column_t * patch, byte * cache, int originy,
 }
 
 
+/*
+===================
+=
+= R_DrawPatchInComposite
+=
+= [JN] Draws the multi-patch columns covered by one patch of the texture
+= into its composite block. Touches nothing but the block, so it is safe
+= to call from worker threads.
+=
+===================
+*/
+
+static void R_DrawPatchInComposite(int texnum, texpatch_t *patch,
+                                   patch_t *realpatch, byte *block)
+{
+    texture_t *texture;
+    int x, x1, x2;
+    column_t *patchcol;
+    short *collump;
+    unsigned short *colofs;
+
+    texture = textures[texnum];
+    collump = texturecolumnlump[texnum];
+    colofs = texturecolumnofs[texnum];
+
+    x1 = patch->originx;
+    x2 = x1 + SHORT(realpatch->width);
+
+    if (x1 < 0)
+        x = 0;
+    else
+        x = x1;
+    if (x2 > texture->width)
+        x2 = texture->width;
+
+    for (; x < x2; x++)
+    {
+        if (collump[x] >= 0)
+            continue;           // column does not have multiple patches
+        patchcol = (column_t *) ((byte *) realpatch +
+                                 LONG(realpatch->columnofs[x - x1]));
+        R_DrawColumnInCache(patchcol, block + colofs[x], patch->originy,
+                            texture->height);
+    }
+}
+
 /*
 ===================
 =
@@ -142,48 +189,21 @@ void R_GenerateComposite(int texnum)
     byte *block;
     texture_t *texture;
     texpatch_t *patch;
-    patch_t *realpatch;
-    int x, x1, x2;
     int i;
-    column_t *patchcol;
-    short *collump;
-    unsigned short *colofs;
 
     texture = textures[texnum];
     block = Z_Malloc(texturecompositesize[texnum], PU_STATIC,
                      &texturecomposite[texnum]);
-    collump = texturecolumnlump[texnum];
-    colofs = texturecolumnofs[texnum];
 
 //
 // composite the columns together
 //
-    patch = texture->patches;
-
     for (i = 0, patch = texture->patches; i < texture->patchcount;
          i++, patch++)
     {
-        realpatch = W_CacheLumpNum(patch->patch, PU_CACHE);
-        x1 = patch->originx;
-        x2 = x1 + SHORT(realpatch->width);
-
-        if (x1 < 0)
-            x = 0;
-        else
-            x = x1;
-        if (x2 > texture->width)
-            x2 = texture->width;
-
-        for (; x < x2; x++)
-        {
-            if (collump[x] >= 0)
-                continue;       // column does not have multiple patches
-            patchcol = (column_t *) ((byte *) realpatch +
-                                     LONG(realpatch->columnofs[x - x1]));
-            R_DrawColumnInCache(patchcol, block + colofs[x], patch->originy,
-                                texture->height);
-        }
-
+        R_DrawPatchInComposite(texnum, patch,
+                               W_CacheLumpNum(patch->patch, PU_CACHE),
+                               block);
     }
 
 // now that the texture has been built, it is purgable
@@ -720,6 +740,169 @@ int R_TextureNumForName(const char *name)
 }
 
 
+/*
+=================
+=
+= R_PrefetchLevel
+=
+= [JN] Hints the flats and wall patches used by the level to the
+= memory-mapped WAD backend, so they are read in the background.
+=================
+*/
+
+void R_PrefetchLevel(void)
+{
+    char *flatpresent;
+    char *texturepresent;
+    int i, j;
+    texture_t *texture;
+
+    flatpresent = Z_Malloc(numflats, PU_STATIC, NULL);
+    memset(flatpresent, 0, numflats);
+    for (i = 0; i < numsectors; i++)
+    {
+        flatpresent[sectors[i].floorpic] = 1;
+        flatpresent[sectors[i].ceilingpic] = 1;
+    }
+
+    for (i = 0; i < numflats; i++)
+        if (flatpresent[i])
+            W_PrefetchLumpNum(firstflat + i);
+
+    Z_Free(flatpresent);
+
+    texturepresent = Z_Malloc(numtextures, PU_STATIC, NULL);
+    memset(texturepresent, 0, numtextures);
+
+    for (i = 0; i < numsides; i++)
+    {
+        texturepresent[sides[i].toptexture] = 1;
+        texturepresent[sides[i].midtexture] = 1;
+        texturepresent[sides[i].bottomtexture] = 1;
+    }
+
+    texturepresent[skytexture] = 1;
+
+    for (i = 0; i < numtextures; i++)
+    {
+        if (!texturepresent[i])
+            continue;
+        texture = textures[i];
+        for (j = 0; j < texture->patchcount; j++)
+            W_PrefetchLumpNum(texture->patches[j].patch);
+    }
+
+    Z_Free(texturepresent);
+}
+
+/*
+=================
+=
+= R_WarmComposites
+=
+= [JN] Builds the composites of every multi-patch texture the level can
+= show, including animation frames and switch states, using worker
+= threads. They are kept as PU_LEVEL, so PU_CACHE purges can't throw them
+= away before the level ends. Unlike R_PrecacheLevel, this is done in
+= demo playback too, so timedemo results don't include compositing.
+=================
+*/
+
+static int *warmtextures;
+static int numwarmtextures;
+static patch_t **warmpatches;
+
+static void R_WarmCompositesJob(int job, int numjobs)
+{
+    int i, j, texnum;
+    texture_t *texture;
+
+    for (i = job; i < numwarmtextures; i += numjobs)
+    {
+        texnum = warmtextures[i];
+        texture = textures[texnum];
+
+        for (j = 0; j < texture->patchcount; j++)
+            R_DrawPatchInComposite(texnum, &texture->patches[j],
+                                   warmpatches[texture->patches[j].patch],
+                                   texturecomposite[texnum]);
+    }
+}
+
+void R_WarmComposites(void)
+{
+    char *texturepresent;
+    int i, j, lump;
+    texture_t *texture;
+
+    texturepresent = Z_Malloc(numtextures, PU_STATIC, NULL);
+    memset(texturepresent, 0, numtextures);
+
+    for (i = 0; i < numsides; i++)
+    {
+        texturepresent[sides[i].toptexture] = 1;
+        texturepresent[sides[i].midtexture] = 1;
+        texturepresent[sides[i].bottomtexture] = 1;
+    }
+
+    texturepresent[skytexture] = 1;
+
+    P_MarkAnimatedTextures(texturepresent);
+    P_MarkSwitchTextures(texturepresent);
+
+    // Allocate all composites up front; Z_Malloc can't be called from
+    // the workers. Composites left over from earlier frames are kept.
+    warmtextures = Z_Malloc(numtextures * sizeof(*warmtextures),
+                            PU_STATIC, NULL);
+    numwarmtextures = 0;
+
+    for (i = 0; i < numtextures; i++)
+    {
+        if (!texturepresent[i] || !texturecompositesize[i])
+            continue;
+
+        if (texturecomposite[i])
+        {
+            Z_ChangeTag(texturecomposite[i], PU_LEVEL);
+            continue;
+        }
+
+        Z_Malloc(texturecompositesize[i], PU_STATIC, &texturecomposite[i]);
+        warmtextures[numwarmtextures++] = i;
+    }
+
+    Z_Free(texturepresent);
+
+    // Lock the patches in memory for as long as the workers need them.
+    warmpatches = Z_Malloc(numlumps * sizeof(*warmpatches), PU_STATIC, NULL);
+    memset(warmpatches, 0, numlumps * sizeof(*warmpatches));
+
+    for (i = 0; i < numwarmtextures; i++)
+    {
+        texture = textures[warmtextures[i]];
+
+        for (j = 0; j < texture->patchcount; j++)
+        {
+            lump = texture->patches[j].patch;
+            if (!warmpatches[lump])
+                warmpatches[lump] = W_CacheLumpNum(lump, PU_STATIC);
+        }
+    }
+
+    if (numwarmtextures > 0)
+        I_RunWorkers(R_WarmCompositesJob, I_GetCPUCount());
+
+    for (i = 0; i < numwarmtextures; i++)
+        Z_ChangeTag(texturecomposite[warmtextures[i]], PU_LEVEL);
+
+    for (i = 0; i < (int) numlumps; i++)
+        if (warmpatches[i])
+            W_ReleaseLumpNum(i);
+
+    Z_Free(warmpatches);
+    Z_Free(warmtextures);
+}
+
 /*
 =================
 =
@@ -59,7 +59,7 @@ fixed_t dc_texturemid;
 byte *dc_source;                // first pixel in a column (possibly virtual)
 
 // [JN] RestlessRodent -- CRL
-visplane_t* dc_visplaneused = NULL;
+THREADLOCAL visplane_t* dc_visplaneused = NULL;
 
 void R_DrawColumn(void)
 {
@@ -81,14 +81,14 @@ void R_DrawColumn(void)
     fracstep = dc_iscale;
     frac = dc_texturemid + (dc_yl - centery) * fracstep;
 
-    do
+    // [JN] RestlessRodent -- Possibly mark visplane
+    if (dc_visplaneused != NULL)
     {
-        // [JN] RestlessRodent -- Possibly mark visplane
-        if (dc_visplaneused != NULL)
-        {
-            CRL_MarkPixelP(CRLPlaneSurface, dc_visplaneused, dest);
-        }
+        CRL_MarkColumn(dc_visplaneused - visplanes, dest, count + 1);
+    }
 
+    do
+    {
         *dest = dc_colormap[dc_source[(frac >> FRACBITS) & 127]];
         dest += SCREENWIDTH;
         frac += fracstep;
@@ -276,15 +276,16 @@ void R_InitTranslationTables(void)
 ================
 */
 
-int ds_y;
-int ds_x1;
-int ds_x2;
-lighttable_t *ds_colormap;
-fixed_t ds_xfrac;
-fixed_t ds_yfrac;
-fixed_t ds_xstep;
-fixed_t ds_ystep;
-byte *ds_source;                // start of a 64*64 tile image
+// [JN] Span state is thread-local, so flats can be drawn by parallel jobs.
+THREADLOCAL int ds_y;
+THREADLOCAL int ds_x1;
+THREADLOCAL int ds_x2;
+THREADLOCAL lighttable_t *ds_colormap;
+THREADLOCAL fixed_t ds_xfrac;
+THREADLOCAL fixed_t ds_yfrac;
+THREADLOCAL fixed_t ds_xstep;
+THREADLOCAL fixed_t ds_ystep;
+THREADLOCAL byte *ds_source;    // start of a 64*64 tile image
 
 
 void R_DrawSpan(void)
@@ -304,16 +305,16 @@ void R_DrawSpan(void)
 
     dest = ylookup[ds_y] + columnofs[ds_x1];
     count = ds_x2 - ds_x1;
+
+    // [JN] RestlessRodent -- Possibly mark visplane
+    if (dc_visplaneused != NULL)
+    {
+        CRL_MarkSpan(dc_visplaneused - visplanes, dest, count + 1);
+    }
+
     do
     {
         spot = ((yfrac >> (16 - 6)) & (63 * 64)) + ((xfrac >> 16) & 63);
-
-        // [JN] RestlessRodent -- Possibly mark visplane
-        if (dc_visplaneused != NULL)
-        {
-            CRL_MarkPixelP(CRLPlaneSurface, dc_visplaneused, dest);
-        }
-
         *dest++ = ds_colormap[ds_source[spot]];
         xfrac += ds_xstep;
         yfrac += ds_ystep;
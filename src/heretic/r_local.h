@@ -165,13 +165,14 @@ typedef struct
 
 typedef byte lighttable_t;      // this could be wider for >8 bit display
 
-typedef struct
+typedef struct visplane_s
 {
     fixed_t height;
     int picnum;
     int lightlevel;
     int special;
     int minx, maxx;
+    struct visplane_s *next;    // Next plane in R_FindPlane hash chain.
 
     // [JN] CRL visplane data:
     int         isfindplane;    // Is a find plane.
@@ -314,6 +315,8 @@ extern lighttable_t *colormaps;
 
 extern void R_InitData(void);
 extern void R_PrecacheLevel(void);
+extern void R_PrefetchLevel(void);
+extern void R_WarmComposites(void);
 
 // -----------------------------------------------------------------------------
 // R_DRAW.C
@@ -321,29 +324,29 @@ extern void R_PrecacheLevel(void);
 
 extern byte *dc_source;         // first pixel in a column
 extern byte *dc_translation;
-extern byte *ds_source;         // start of a 64*64 tile image
+extern THREADLOCAL byte *ds_source; // start of a 64*64 tile image
 extern byte *translationtables;
 extern byte *ylookup[MAXHEIGHT];
 
 extern fixed_t dc_iscale;
 extern fixed_t dc_texturemid;
-extern fixed_t ds_xfrac;
-extern fixed_t ds_xstep;
-extern fixed_t ds_yfrac;
-extern fixed_t ds_ystep;
+extern THREADLOCAL fixed_t ds_xfrac;
+extern THREADLOCAL fixed_t ds_xstep;
+extern THREADLOCAL fixed_t ds_yfrac;
+extern THREADLOCAL fixed_t ds_ystep;
 
 extern int columnofs[MAXWIDTH];
 extern int dc_x;
 extern int dc_yh;
 extern int dc_yl;
-extern int ds_x1;
-extern int ds_x2;
-extern int ds_y;
+extern THREADLOCAL int ds_x1;
+extern THREADLOCAL int ds_x2;
+extern THREADLOCAL int ds_y;
 
 extern lighttable_t *dc_colormap;
-extern lighttable_t *ds_colormap;
+extern THREADLOCAL lighttable_t *ds_colormap;
 
-extern visplane_t *dc_visplaneused; // RestlessRodent -- CRL
+extern THREADLOCAL visplane_t *dc_visplaneused; // RestlessRodent -- CRL
 
 extern void R_DrawColumn(void);
 extern void R_DrawColumnLow(void);
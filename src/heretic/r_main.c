@@ -902,7 +902,9 @@ void R_RenderPlayerView(player_t * player)
 	// [JN] RestlessRodent -- Do not spawn it just in case.
 	if (js == 0)
 	{
+        CRL_ProfStart(CRL_PROF_SETUP);
         R_SetupFrame(player);
+        CRL_ProfStop(CRL_PROF_SETUP);
 
 		// Clear the view buffer
         // [JN] CRL - allow to choose HOM effect.
@@ -927,12 +929,20 @@ void R_RenderPlayerView(player_t * player)
         {
             R_InterpolateTextureOffsets(); // [crispy] smooth texture scrolling
         }
+        CRL_ProfStart(CRL_PROF_BSP);
         R_RenderBSPNode(numnodes - 1);      // the head node is the last node output
+        CRL_ProfStop(CRL_PROF_BSP);
         NetUpdate();                // check for new console commands
+        CRL_ProfStart(CRL_PROF_PLANES);
         R_DrawPlanes();
+        CRL_ProfStop(CRL_PROF_PLANES);
+        CRL_ProfStart(CRL_PROF_VISPLANES);
         CRL_DrawVisPlanes(0);
+        CRL_ProfStop(CRL_PROF_VISPLANES);
         NetUpdate();                // check for new console commands
+        CRL_ProfStart(CRL_PROF_MASKED);
         R_DrawMasked();
+        CRL_ProfStop(CRL_PROF_MASKED);
         NetUpdate();                // check for new console commands
 
         js = -1;                    // No errors, set jump to negative for OK
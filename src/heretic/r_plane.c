@@ -21,10 +21,12 @@
 #include "doomdef.h"
 #include "deh_str.h"
 #include "i_system.h"
+#include "i_thread.h"
 #include "m_misc.h"
 #include "r_local.h"
 
 #include "crlcore.h"
+#include "crlvars.h"
 
 
 //
@@ -43,6 +45,15 @@ fixed_t skyiscale;
 visplane_t visplanes[REALMAXVISPLANES], *lastvisplane;
 visplane_t *floorplane, *ceilingplane;
 
+// Hash chains of visplanes by height, picnum and lightlevel. Only the
+// first plane of every kind is linked, so lookup returns the same plane
+// as the linear scan of vanilla R_FindPlane.
+#define MAXVISPLANEHASH 512
+#define visplane_hash(picnum,lightlevel,height) \
+    (((unsigned)(picnum)*3+(unsigned)(lightlevel)+(unsigned)(height)*7) & (MAXVISPLANEHASH-1))
+
+static visplane_t *visplanehash[MAXVISPLANEHASH];
+
 // [JN] CRL - remove MAXOPENINGS limit enterily. 
 // Render limits level will still do actual drawing limit.
 size_t  maxopenings;
@@ -61,23 +72,34 @@ int ceilingclip[SCREENWIDTH];
 // spanstart holds the start of a plane span
 // initialized to 0 at start
 //
-int spanstart[SCREENHEIGHT];
+// [JN] Thread-local, as well as span caches and texture mapping
+// below, so flats can be drawn by parallel jobs.
+//
+THREADLOCAL int spanstart[SCREENHEIGHT];
 int spanstop[SCREENHEIGHT];
 
 //
 // texture mapping
 //
-lighttable_t **planezlight;
-fixed_t planeheight;
+THREADLOCAL lighttable_t **planezlight;
+THREADLOCAL fixed_t planeheight;
 
 fixed_t yslope[SCREENHEIGHT];
 fixed_t distscale[SCREENWIDTH];
 fixed_t basexscale, baseyscale;
 
-fixed_t cachedheight[SCREENHEIGHT];
-fixed_t cacheddistance[SCREENHEIGHT];
-fixed_t cachedxstep[SCREENHEIGHT];
-fixed_t cachedystep[SCREENHEIGHT];
+THREADLOCAL fixed_t cachedheight[SCREENHEIGHT];
+THREADLOCAL fixed_t cacheddistance[SCREENHEIGHT];
+THREADLOCAL fixed_t cachedxstep[SCREENHEIGHT];
+THREADLOCAL fixed_t cachedystep[SCREENHEIGHT];
+
+// [JN] Parallel flat drawing: every job draws only the rows
+// where y % planejobs == planejob.
+static THREADLOCAL int planejob;
+static THREADLOCAL int planejobs = 1;
+
+// Flat data of every visplane, cached before running parallel jobs.
+static byte *planesource[REALMAXVISPLANES];
 
 void GAME_IdentifyPlane(void* __what, CRLPlaneData_t* __info)
 {
@@ -158,6 +180,12 @@ static void R_MapPlane (int y, int x1, int x2, visplane_t* __plane)
         I_Error("R_MapPlane: %i, %i at %i", x1, x2, y);
 #endif
 
+    // [JN] Row belongs to another parallel job.
+    if (planejobs > 1 && y % planejobs != planejob)
+    {
+        return;
+    }
+
     if (planeheight != cachedheight[y])
     {
         cachedheight[y] = planeheight;
@@ -224,6 +252,7 @@ void R_ClearPlanes(void)
 
     lastvisplane = visplanes;
     lastopening = openings;
+    memset(visplanehash, 0, sizeof(visplanehash));
 
 //
 // texture calculation
@@ -251,6 +280,7 @@ visplane_t *R_FindPlane(fixed_t height, int picnum,
                         seg_t* __line, subsector_t* __sub)
 {
     visplane_t *check;
+    unsigned hash;
 
     if (picnum == skyflatnum)
     {
@@ -259,18 +289,17 @@ visplane_t *R_FindPlane(fixed_t height, int picnum,
         lightlevel = 0;
     }
 
-    for (check = visplanes; check < lastvisplane; check++)
+    hash = visplane_hash(picnum, lightlevel, height);
+
+    for (check = visplanehash[hash]; check; check = check->next)
     {
         if (height == check->height
             && picnum == check->picnum
             && lightlevel == check->lightlevel && special == check->special)
-            break;
+            return (check);
     }
 
-    if (check < lastvisplane)
-    {
-        return (check);
-    }
+    check = lastvisplane;
 
     if (lastvisplane - visplanes == REALMAXVISPLANES)
     {
@@ -296,6 +325,10 @@ visplane_t *R_FindPlane(fixed_t height, int picnum,
     check->emitsub = __sub;
 
     memset(check->top, 0xff, sizeof(check->top));
+
+    check->next = visplanehash[hash];
+    visplanehash[hash] = check;
+
     return (check);
 }
 
@@ -422,6 +455,68 @@ void R_MakeSpans(unsigned int x,  // [JN] 32-bit integer math
 
 
 
+/*
+================
+=
+= R_DrawFlat
+=
+= [JN] Draws regular flat visplane, using given flat data
+================
+*/
+
+static void R_DrawFlat(visplane_t *pl, byte *source)
+{
+    int light;
+    int x, stop;
+
+    ds_source = source;
+
+    planeheight = abs(pl->height - viewz);
+    light = (pl->lightlevel >> LIGHTSEGSHIFT) + extralight;
+    if (light >= LIGHTLEVELS)
+        light = LIGHTLEVELS - 1;
+    if (light < 0)
+        light = 0;
+    planezlight = zlight[light];
+
+    stop = pl->maxx + 1;
+    for (x = pl->minx; x <= stop; x++)
+        R_MakeSpans(x, pl->top[x - 1], pl->bottom[x - 1], pl->top[x],
+                    pl->bottom[x], pl);
+}
+
+/*
+================
+=
+= R_DrawPlanesJob
+=
+= [JN] One of parallel jobs drawing regular flats. Every job walks all
+= the visplanes, but draws only its own rows, so no pixel is shared.
+================
+*/
+
+static void R_DrawPlanesJob(int job, int numjobs)
+{
+    visplane_t *pl;
+
+    planejob = job;
+    planejobs = numjobs;
+
+    // Span caches of this thread may be left from previous frame.
+    memset(cachedheight, 0, sizeof(cachedheight));
+
+    for (pl = visplanes; pl < lastvisplane; pl++)
+    {
+        if (planesource[pl - visplanes] != NULL)
+        {
+            R_DrawFlat(pl, planesource[pl - visplanes]);
+        }
+    }
+
+    planejob = 0;
+    planejobs = 1;
+}
+
 /*
 ================
 =
@@ -434,11 +529,18 @@ void R_MakeSpans(unsigned int x,  // [JN] 32-bit integer math
 void R_DrawPlanes(void)
 {
     visplane_t *pl;
-    int light;
-    int x, stop;
+    int x;
     int lumpnum;
     int angle;
     byte *tempSource;
+    byte *source;
+    // [JN] Draw flats by parallel jobs if asked. Visplane drawing mode
+    // needs to mark every span on shared surface, so it stays serial.
+#ifdef HAVE_THREADLOCAL
+    const boolean parallel = crl_plane_threads > 1 && !crl_visplanes_drawing;
+#else
+    const boolean parallel = false;
+#endif
 
     byte *dest;
     int count;
@@ -519,13 +621,12 @@ void R_DrawPlanes(void)
                     fracstep = 1;
                     frac = (dc_texturemid >> FRACBITS) + (dc_yl - centery);
                     dc_visplaneused = pl;
+
+                    // RestlessRodent -- Possibly mark visplane
+                    CRL_MarkColumn(pl - visplanes, dest, count + 1);
+
                     do
                     {
-                        // RestlessRodent -- Possibly mark visplane
-                        if (dc_visplaneused != NULL)
-                        {
-                            CRL_MarkPixelP(CRLPlaneSurface, dc_visplaneused, dest);
-                        }
                         *dest = dc_source[frac];
                         dest += SCREENWIDTH;
                         frac += fracstep;
@@ -553,54 +654,65 @@ void R_DrawPlanes(void)
             case 27:
             case 28:
             case 29:           // Scroll_North
-                ds_source = tempSource;
+                source = tempSource;
                 break;
             case 20:
             case 21:
             case 22:
             case 23:
             case 24:           // Scroll_East
-                ds_source = tempSource + ((63 - ((leveltime >> 1) & 63)) <<
-                                          (pl->special - 20) & 63);
-                //ds_source = tempSource+((leveltime>>1)&63);
+                source = tempSource + ((63 - ((leveltime >> 1) & 63)) <<
+                                       (pl->special - 20) & 63);
+                //source = tempSource+((leveltime>>1)&63);
                 break;
             case 30:
             case 31:
             case 32:
             case 33:
             case 34:           // Scroll_South
-                ds_source = tempSource;
+                source = tempSource;
                 break;
             case 35:
             case 36:
             case 37:
             case 38:
             case 39:           // Scroll_West
-                ds_source = tempSource;
+                source = tempSource;
                 break;
             case 4:            // Scroll_EastLavaDamage
-                ds_source =
+                source =
                     tempSource + (((63 - ((leveltime >> 1) & 63)) << 3) & 63);
                 break;
             default:
-                ds_source = tempSource;
+                source = tempSource;
         }
-        planeheight = abs(pl->height - viewz);
-        light = (pl->lightlevel >> LIGHTSEGSHIFT) + extralight;
-        if (light >= LIGHTLEVELS)
-            light = LIGHTLEVELS - 1;
-        if (light < 0)
-            light = 0;
-        planezlight = zlight[light];
 
         pl->top[pl->maxx + 1] = 0xffffu;
         pl->top[pl->minx - 1] = 0xffffu;
 
-        stop = pl->maxx + 1;
-        for (x = pl->minx; x <= stop; x++)
-            R_MakeSpans(x, pl->top[x - 1], pl->bottom[x - 1], pl->top[x],
-                        pl->bottom[x], pl);
+        // [JN] Keep flat cached until parallel jobs are done with it.
+        if (parallel)
+        {
+            planesource[pl - visplanes] = source;
+            continue;
+        }
+
+        R_DrawFlat(pl, source);
 
         W_ReleaseLumpNum(lumpnum);
     }
+
+    if (parallel)
+    {
+        I_RunWorkers(R_DrawPlanesJob, crl_plane_threads);
+
+        for (pl = visplanes; pl < lastvisplane; pl++)
+        {
+            if (planesource[pl - visplanes] != NULL)
+            {
+                W_ReleaseLumpNum(firstflat + flattranslation[pl->picnum]);
+                planesource[pl - visplanes] = NULL;
+            }
+        }
+    }
 }
@@ -898,49 +898,53 @@ vissprite_t vsprsortedhead;
 
 void R_SortVisSprites(void)
 {
-    int i, count;
-    vissprite_t *ds, *best;
-    static vissprite_t unsorted;
-    fixed_t bestscale;
+    int i, count, width;
+    int lo, mid, hi, l, r;
+    vissprite_t **src, **dst, **swap;
+    static vissprite_t *sortbuf[2][REALMAXVISSPRITES];
 
     count = vissprite_p - vissprites;
-
-    unsorted.next = unsorted.prev = &unsorted;
     if (!count)
         return;
 
-    for (ds = vissprites; ds < vissprite_p; ds++)
-    {
-        ds->next = ds + 1;
-        ds->prev = ds - 1;
-    }
-    vissprites[0].prev = &unsorted;
-    unsorted.next = &vissprites[0];
-    (vissprite_p - 1)->next = &unsorted;
-    unsorted.prev = vissprite_p - 1;
+    src = sortbuf[0];
+    dst = sortbuf[1];
+
+    for (i = 0; i < count; i++)
+        src[i] = &vissprites[i];
 
 //
-// pull the vissprites out by scale
+// bottom-up merge sort by scale, stable, so sprites of equal scale
+// keep the order vanilla's repeated minimum selection gave them
 //
-    best = 0;                   // shut up the compiler warning
-    vsprsortedhead.next = vsprsortedhead.prev = &vsprsortedhead;
-    for (i = 0; i < count; i++)
+    for (width = 1; width < count; width *= 2)
     {
-        bestscale = INT_MAX;
-        for (ds = unsorted.next; ds != &unsorted; ds = ds->next)
+        for (lo = 0; lo < count; lo += width * 2)
         {
-            if (ds->scale < bestscale)
+            mid = MIN(lo + width, count);
+            hi = MIN(lo + width * 2, count);
+
+            for (i = lo, l = lo, r = mid; i < hi; i++)
             {
-                bestscale = ds->scale;
-                best = ds;
+                if (l < mid && (r >= hi || src[l]->scale <= src[r]->scale))
+                    dst[i] = src[l++];
+                else
+                    dst[i] = src[r++];
             }
         }
-        best->next->prev = best->prev;
-        best->prev->next = best->next;
-        best->next = &vsprsortedhead;
-        best->prev = vsprsortedhead.prev;
-        vsprsortedhead.prev->next = best;
-        vsprsortedhead.prev = best;
+
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    vsprsortedhead.next = vsprsortedhead.prev = &vsprsortedhead;
+    for (i = 0; i < count; i++)
+    {
+        src[i]->next = &vsprsortedhead;
+        src[i]->prev = vsprsortedhead.prev;
+        vsprsortedhead.prev->next = src[i];
+        vsprsortedhead.prev = src[i];
     }
 }
 
@@ -45,7 +45,8 @@
 void S_ShutDown(void);
 boolean S_StopSoundID(int sound_id, int priority);
 
-static channel_t channel[MAX_CHANNELS];
+// [JN] Sized for the native mixer, which can play more than MAX_CHANNELS.
+static channel_t channel[MAX_MIX_VOICES];
 
 static void *rs;          // Handle for the registered song
 int mus_song = -1;
@@ -546,7 +547,17 @@ void S_Init(void)
 {
     I_SetOPLDriverVer(opl_doom2_1_666);
     soundCurve = Z_Malloc(MAX_SND_DIST, PU_STATIC, NULL);
-    if (snd_Channels > 8)
+    // [JN] The native mixer can play more sounds at once.
+    if (I_NativeMixerActive())
+    {
+        if (snd_Channels > MAX_MIX_VOICES)
+        {
+            fprintf(stderr, "S_Init: snd_channels %d is above the limit "
+                            "of %d, lowering.\n", snd_Channels, MAX_MIX_VOICES);
+            snd_Channels = MAX_MIX_VOICES;
+        }
+    }
+    else if (snd_Channels > 8)
     {
         snd_Channels = 8;
     }
@@ -569,7 +580,8 @@ void S_GetChannelInfo(SoundInfo_t * s)
     int i;
     ChanInfo_t *c;
 
-    s->channelCount = snd_Channels;
+    // [JN] Only as many channels as fit on the debug screen.
+    s->channelCount = MIN(snd_Channels, arrlen(s->chan));
     s->musicVolume = snd_MusicVolume;
     s->soundVolume = snd_MaxVolume;
     for (i = 0; i < snd_Channels; i++)
@@ -0,0 +1,585 @@
+//
+// Copyright(C) 2005-2014 Simon Howard
+// Copyright(C) 2018-2024 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Native sound effects mixer. Plays raw DMX sound lumps, resampling
+//	them on the fly, and mixes them as SDL_mixer postmix effect,
+//	so music modules keep working on the same audio device.
+//
+
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SDL.h"
+
+#include "deh_str.h"
+#include "i_sound.h"
+#include "m_misc.h"
+#include "w_wad.h"
+#include "z_zone.h"
+
+#include "doomtype.h"
+
+#ifndef DISABLE_SDL2MIXER
+
+#include "SDL_mixer.h"
+
+#if defined(__SSE2__) || defined(_M_X64) \
+ || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIX_SSE2
+#include <emmintrin.h>
+#endif
+
+// Output samples mixed at once.
+
+#define MIX_BLOCK 256
+
+// Sound lump, as stored in sfxinfo->driver_data.
+
+typedef struct
+{
+    const byte *data;       // Unsigned 8-bit mono samples.
+    unsigned int length;    // Number of samples, 0 if not a valid sound.
+    int samplerate;
+} mixsound_t;
+
+// Sound playing on a channel.
+
+typedef struct
+{
+    const byte *data;       // NULL if nothing is playing.
+    unsigned int length;
+    unsigned int pos;       // Current sample.
+    unsigned int frac;      // Fraction of current sample, 0-65535.
+    unsigned int step;      // Samples advanced per output sample, 16.16.
+    int left, right;        // Volume of each side, 0-256.
+} mixvoice_t;
+
+static boolean sound_initialized = false;
+
+static SDL_mutex *sound_lock;
+static mixvoice_t voices[MAX_MIX_VOICES];
+
+static int mixer_freq;
+static Uint16 mixer_format;
+static int mixer_channels;
+static boolean use_sfx_prefix;
+
+//
+// Reads sound lump header and keeps raw samples in memory. Sounds are
+// checked the same way as in SDL module, so the same lumps play or fail.
+//
+
+static mixsound_t *CacheMixSound(sfxinfo_t *sfxinfo)
+{
+    mixsound_t *snd = sfxinfo->driver_data;
+    unsigned int lumplen;
+    unsigned int length;
+    byte *data;
+
+    if (snd != NULL)
+    {
+        return snd;
+    }
+
+    snd = Z_Malloc(sizeof(*snd), PU_STATIC, NULL);
+    snd->data = NULL;
+    snd->length = 0;
+    snd->samplerate = 0;
+    sfxinfo->driver_data = snd;
+
+    if (sfxinfo->lumpnum < 0)
+    {
+        return snd;
+    }
+
+    data = W_CacheLumpNum(sfxinfo->lumpnum, PU_STATIC);
+    lumplen = W_LumpLength(sfxinfo->lumpnum);
+    length = lumplen < 8 ? 0 :
+             (data[7] << 24) | (data[6] << 16) | (data[5] << 8) | data[4];
+
+    if (lumplen >= 8 && data[0] == 0x03 && data[1] == 0x00
+     && length <= lumplen - 8 && length > 48)
+    {
+        byte *samples;
+
+        // Skip the first 16 and last 16 bytes, as DMX does. Samples are
+        // copied as they are, since the lump itself may be freed when
+        // its WAD is reloaded.
+
+        length -= 32;
+        samples = Z_Malloc(length, PU_STATIC, NULL);
+        memcpy(samples, data + 8 + 16, length);
+
+        snd->data = samples;
+        snd->samplerate = (data[3] << 8) | data[2];
+        snd->length = snd->samplerate > 0 ? length : 0;
+    }
+
+    W_ReleaseLumpNum(sfxinfo->lumpnum);
+
+    return snd;
+}
+
+//
+// Resamples up to n samples of a voice into signed 16-bit buffer,
+// linearly interpolating between source samples. Returns number of
+// samples written, less than n if the sound has ended.
+//
+
+static int ResampleVoice(mixvoice_t *voice, Sint16 *out, int n)
+{
+    const byte *data = voice->data;
+    const unsigned int length = voice->length;
+    const unsigned int step = voice->step;
+    unsigned int pos = voice->pos;
+    unsigned int frac = voice->frac;
+    int i;
+
+    for (i = 0; i < n && pos < length; ++i)
+    {
+        const int a = data[pos] - 128;
+        const int b = (pos + 1 < length ? data[pos + 1] : 128) - 128;
+
+        out[i] = (Sint16) ((a << 8) + (((b - a) * (int) frac) >> 8));
+
+        frac += step;
+        pos += frac >> 16;
+        frac &= 0xffff;
+    }
+
+    voice->pos = pos;
+    voice->frac = frac;
+
+    return i;
+}
+
+//
+// Adds n samples to both sides with given volumes.
+//
+
+static void MixVoice(Sint32 *mix_left, Sint32 *mix_right,
+                     const Sint16 *in, int n, int left, int right)
+{
+    int i = 0;
+
+#ifdef MIX_SSE2
+    const __m128i vleft = _mm_set1_epi16((short) left);
+    const __m128i vright = _mm_set1_epi16((short) right);
+
+    // 8 samples at once: 16x16 bit products are split into low and
+    // high halves and interleaved back into 32-bit values.
+
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m128i s = _mm_loadu_si128((const __m128i *) (in + i));
+        const __m128i llo = _mm_mullo_epi16(s, vleft);
+        const __m128i lhi = _mm_mulhi_epi16(s, vleft);
+        const __m128i rlo = _mm_mullo_epi16(s, vright);
+        const __m128i rhi = _mm_mulhi_epi16(s, vright);
+        __m128i *l = (__m128i *) (mix_left + i);
+        __m128i *r = (__m128i *) (mix_right + i);
+
+        _mm_storeu_si128(l, _mm_add_epi32(_mm_loadu_si128(l),
+                                          _mm_unpacklo_epi16(llo, lhi)));
+        _mm_storeu_si128(l + 1, _mm_add_epi32(_mm_loadu_si128(l + 1),
+                                              _mm_unpackhi_epi16(llo, lhi)));
+        _mm_storeu_si128(r, _mm_add_epi32(_mm_loadu_si128(r),
+                                          _mm_unpacklo_epi16(rlo, rhi)));
+        _mm_storeu_si128(r + 1, _mm_add_epi32(_mm_loadu_si128(r + 1),
+                                              _mm_unpackhi_epi16(rlo, rhi)));
+    }
+#endif
+
+    for (; i < n; ++i)
+    {
+        mix_left[i] += in[i] * left;
+        mix_right[i] += in[i] * right;
+    }
+}
+
+static Sint16 Clip16(Sint32 x)
+{
+    return (Sint16) (x < -32768 ? -32768 : x > 32767 ? 32767 : x);
+}
+
+//
+// Adds mixed block to the output stream, which already has the music
+// in it. Mixed sounds are clipped first, then the sum is clipped.
+//
+
+static void WriteBlock(Sint16 *stream, const Sint32 *mix_left,
+                       const Sint32 *mix_right, int n)
+{
+    int i = 0;
+
+#ifdef MIX_SSE2
+    // 4 samples at once: both sides are interleaved as in the stream
+    // and packed into 16 bits with saturation.
+
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m128i l = _mm_srai_epi32(
+            _mm_loadu_si128((const __m128i *) (mix_left + i)), 8);
+        const __m128i r = _mm_srai_epi32(
+            _mm_loadu_si128((const __m128i *) (mix_right + i)), 8);
+        const __m128i mix = _mm_packs_epi32(_mm_unpacklo_epi32(l, r),
+                                            _mm_unpackhi_epi32(l, r));
+        __m128i *out = (__m128i *) (stream + i * 2);
+
+        _mm_storeu_si128(out, _mm_adds_epi16(_mm_loadu_si128(out), mix));
+    }
+#endif
+
+    for (; i < n; ++i)
+    {
+        stream[i * 2] = Clip16(stream[i * 2] + Clip16(mix_left[i] >> 8));
+        stream[i * 2 + 1] = Clip16(stream[i * 2 + 1]
+                                 + Clip16(mix_right[i] >> 8));
+    }
+}
+
+static void I_MIX_Callback(int chan, void *stream, int len, void *udata)
+{
+    Sint32 mix_left[MIX_BLOCK], mix_right[MIX_BLOCK];
+    Sint16 samples[MIX_BLOCK];
+    Sint16 *out = stream;
+    int remaining = len / 4;
+
+    SDL_LockMutex(sound_lock);
+
+    while (remaining > 0)
+    {
+        const int n = remaining < MIX_BLOCK ? remaining : MIX_BLOCK;
+        boolean playing = false;
+        int i;
+
+        memset(mix_left, 0, n * sizeof(*mix_left));
+        memset(mix_right, 0, n * sizeof(*mix_right));
+
+        for (i = 0; i < MAX_MIX_VOICES; ++i)
+        {
+            mixvoice_t *voice = &voices[i];
+            int count;
+
+            if (voice->data == NULL)
+            {
+                continue;
+            }
+
+            count = ResampleVoice(voice, samples, n);
+            MixVoice(mix_left, mix_right, samples, count,
+                     voice->left, voice->right);
+            playing = true;
+
+            if (voice->pos >= voice->length)
+            {
+                voice->data = NULL;
+            }
+        }
+
+        if (playing)
+        {
+            WriteBlock(out, mix_left, mix_right, n);
+        }
+
+        out += n * 2;
+        remaining -= n;
+    }
+
+    SDL_UnlockMutex(sound_lock);
+}
+
+static void GetSfxLumpName(sfxinfo_t *sfx, char *buf, size_t buf_len)
+{
+    // Linked sfx lumps? Get the lump number for the sound linked to.
+
+    if (sfx->link != NULL)
+    {
+        sfx = sfx->link;
+    }
+
+    // Doom adds a DS* prefix to sound lumps; Heretic and Hexen don't
+    // do this.
+
+    if (use_sfx_prefix)
+    {
+        M_snprintf(buf, buf_len, "ds%s", DEH_String(sfx->name));
+    }
+    else
+    {
+        M_StringCopy(buf, DEH_String(sfx->name), buf_len);
+    }
+}
+
+// Raw samples are small, so precaching only copies them into memory.
+
+static void I_MIX_PrecacheSounds(sfxinfo_t *sounds, int num_sounds)
+{
+    char namebuf[9];
+    int i;
+
+    for (i = 0; i < num_sounds; ++i)
+    {
+        if (sounds[i].driver_data == NULL)
+        {
+            GetSfxLumpName(&sounds[i], namebuf, sizeof(namebuf));
+            sounds[i].lumpnum = W_CheckNumForName(namebuf);
+            CacheMixSound(&sounds[i]);
+        }
+    }
+}
+
+static int I_MIX_GetSfxLumpNum(sfxinfo_t *sfx)
+{
+    char namebuf[9];
+
+    GetSfxLumpName(sfx, namebuf, sizeof(namebuf));
+
+    // [crispy] make missing sounds non-fatal
+    return W_CheckNumForName(namebuf);
+}
+
+// Same volume curve as Mix_SetPanning in SDL module, but scaled
+// to 0-256 so the mixer only needs a shift.
+
+static int PanVolume(int vol)
+{
+    if (vol < 0) vol = 0;
+    else if (vol > 255) vol = 255;
+
+    return (vol * 256) / 255;
+}
+
+static void I_MIX_UpdateSoundParams(int handle, int vol, int sep)
+{
+    int left, right;
+
+    if (!sound_initialized || handle < 0 || handle >= MAX_MIX_VOICES)
+    {
+        return;
+    }
+
+    left = PanVolume(((254 - sep) * vol) / 127);
+    right = PanVolume((sep * vol) / 127);
+
+    SDL_LockMutex(sound_lock);
+    voices[handle].left = left;
+    voices[handle].right = right;
+    SDL_UnlockMutex(sound_lock);
+}
+
+static int I_MIX_StartSound(sfxinfo_t *sfxinfo, int channel, int vol, int sep, int pitch)
+{
+    const mixsound_t *snd;
+    mixvoice_t voice;
+    uint64_t step;
+
+    if (!sound_initialized || channel < 0 || channel >= MAX_MIX_VOICES)
+    {
+        return -1;
+    }
+
+    snd = CacheMixSound(sfxinfo);
+
+    if (snd->length == 0)
+    {
+        return -1;
+    }
+
+    // Pitch shifting only changes the playback rate, using the same
+    // approximation of vanilla behaviour as SDL module.
+
+    step = ((uint64_t) snd->samplerate << 16) / mixer_freq;
+
+    if (snd_pitchshift && pitch != NORM_PITCH && pitch < 2 * NORM_PITCH)
+    {
+        step = step * NORM_PITCH / (2 * NORM_PITCH - pitch);
+    }
+
+    voice.data = snd->data;
+    voice.length = snd->length;
+    voice.pos = 0;
+    voice.frac = 0;
+    voice.step = step > 0 ? (unsigned int) step : 1;
+    voice.left = PanVolume(((254 - sep) * vol) / 127);
+    voice.right = PanVolume((sep * vol) / 127);
+
+    SDL_LockMutex(sound_lock);
+    voices[channel] = voice;
+    SDL_UnlockMutex(sound_lock);
+
+    return channel;
+}
+
+static void I_MIX_StopSound(int handle)
+{
+    if (!sound_initialized || handle < 0 || handle >= MAX_MIX_VOICES)
+    {
+        return;
+    }
+
+    SDL_LockMutex(sound_lock);
+    voices[handle].data = NULL;
+    SDL_UnlockMutex(sound_lock);
+}
+
+static boolean I_MIX_SoundIsPlaying(int handle)
+{
+    boolean result;
+
+    if (!sound_initialized || handle < 0 || handle >= MAX_MIX_VOICES)
+    {
+        return false;
+    }
+
+    SDL_LockMutex(sound_lock);
+    result = voices[handle].data != NULL;
+    SDL_UnlockMutex(sound_lock);
+
+    return result;
+}
+
+// Finished voices are stopped by the mixer itself.
+
+static void I_MIX_UpdateSound(void)
+{
+}
+
+static void I_MIX_ShutdownSound(void)
+{
+    if (!sound_initialized)
+    {
+        return;
+    }
+
+    Mix_UnregisterEffect(MIX_CHANNEL_POST, I_MIX_Callback);
+    Mix_CloseAudio();
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+    SDL_DestroyMutex(sound_lock);
+
+    sound_initialized = false;
+}
+
+// Calculate slice size, based on snd_maxslicetime_ms.
+// The result must be a power of two.
+
+static int GetSliceSize(void)
+{
+    int limit;
+    int n;
+
+    limit = (snd_samplerate * snd_maxslicetime_ms) / 1000;
+
+    // Try all powers of two, not exceeding the limit.
+
+    for (n=0;; ++n)
+    {
+        // 2^n <= limit < 2^n+1 ?
+
+        if ((1 << (n + 1)) > limit)
+        {
+            return (1 << n);
+        }
+    }
+
+    // Should never happen?
+
+    return 1024;
+}
+
+static boolean I_MIX_InitSound(GameMission_t mission)
+{
+    // Disabled, let SDL module play the sounds.
+
+    if (!snd_nativemixer)
+    {
+        return false;
+    }
+
+    use_sfx_prefix = (mission == doom || mission == strife);
+    memset(voices, 0, sizeof(voices));
+
+    if (SDL_Init(SDL_INIT_AUDIO) < 0)
+    {
+        fprintf(stderr, "Unable to set up sound.\n");
+        return false;
+    }
+
+    if (Mix_OpenAudioDevice(snd_samplerate, AUDIO_S16SYS, 2, GetSliceSize(), NULL, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE) < 0)
+    {
+        fprintf(stderr, "Error initialising SDL_mixer: %s\n", Mix_GetError());
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        return false;
+    }
+
+    Mix_QuerySpec(&mixer_freq, &mixer_format, &mixer_channels);
+
+    if (mixer_format != AUDIO_S16SYS || mixer_channels != 2)
+    {
+        fprintf(stderr, "I_MIX_InitSound: unsupported output format, "
+                        "falling back to SDL_mixer channels.\n");
+        Mix_CloseAudio();
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        return false;
+    }
+
+    sound_lock = SDL_CreateMutex();
+
+    // No SDL_mixer channels are used. Music modules play on the same
+    // device as before; the OPL module mixes its output in through
+    // its own postmix effect, registered in OPL_SDL_Init.
+
+    Mix_AllocateChannels(0);
+    Mix_RegisterEffect(MIX_CHANNEL_POST, I_MIX_Callback, NULL, NULL);
+
+    SDL_PauseAudio(0);
+
+    printf("I_MIX_InitSound: native mixer, %d voices at %d Hz.\n",
+           MAX_MIX_VOICES, mixer_freq);
+
+    sound_initialized = true;
+
+    return true;
+}
+
+static const snddevice_t sound_mix_devices[] =
+{
+    SNDDEVICE_SB,
+    SNDDEVICE_PAS,
+    SNDDEVICE_GUS,
+    SNDDEVICE_WAVEBLASTER,
+    SNDDEVICE_SOUNDCANVAS,
+    SNDDEVICE_AWE32,
+};
+
+const sound_module_t sound_mix_module =
+{
+    sound_mix_devices,
+    arrlen(sound_mix_devices),
+    I_MIX_InitSound,
+    I_MIX_ShutdownSound,
+    I_MIX_GetSfxLumpNum,
+    I_MIX_UpdateSound,
+    I_MIX_UpdateSoundParams,
+    I_MIX_StartSound,
+    I_MIX_StopSound,
+    I_MIX_SoundIsPlaying,
+    I_MIX_PrecacheSounds,
+};
+
+#endif // DISABLE_SDL2MIXER
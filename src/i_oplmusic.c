@@ -1624,24 +1624,24 @@ static boolean IsMid(byte *mem, int len)
     return len > 4 && !memcmp(mem, "MThd", 4);
 }
 
-static boolean ConvertMus(byte *musdata, int len, char *filename)
+// Convert MUS to MIDI in memory and parse the result.
+
+static midi_file_t *ConvertMus(byte *musdata, int len)
 {
     MEMFILE *instream;
     MEMFILE *outstream;
     void *outbuf;
     size_t outbuf_len;
-    int result;
+    midi_file_t *result = NULL;
 
     instream = mem_fopen_read(musdata, len);
     outstream = mem_fopen_write();
 
-    result = mus2mid(instream, outstream);
-
-    if (result == 0)
+    if (mus2mid(instream, outstream) == 0)
     {
         mem_get_buf(outstream, &outbuf, &outbuf_len);
 
-        M_WriteFile(filename, outbuf, outbuf_len);
+        result = MIDI_LoadFromMemory(outbuf, outbuf_len);
     }
 
     mem_fclose(instream);
@@ -1653,7 +1653,6 @@ static boolean ConvertMus(byte *musdata, int len, char *filename)
 static void *I_OPL_RegisterSong(void *data, int len)
 {
     midi_file_t *result;
-    char *filename;
 
     if (!music_initialized)
     {
@@ -1663,8 +1662,6 @@ static void *I_OPL_RegisterSong(void *data, int len)
     // MUS files begin with "MUS"
     // Reject anything which doesnt have this signature
 
-    filename = M_TempFile("doom.mid");
-
     // [JN] CRL - print a warning about 96 kilobytes limit.
     if (len >= MAXMIDLENGTH)
     {
@@ -1675,29 +1672,22 @@ static void *I_OPL_RegisterSong(void *data, int len)
 
     if (IsMid(data, len) && len < MAXMIDLENGTH)
     {
-        M_WriteFile(filename, data, len);
         // [JN] CRL - Check if MIDI file is valid.
         MIDI_CheckFile(data, len);
+        result = MIDI_LoadFromMemory(data, len);
     }
     else
     {
         // Assume a MUS file and try to convert
 
-        ConvertMus(data, len, filename);
+        result = ConvertMus(data, len);
     }
 
-    result = MIDI_LoadFile(filename);
-
     if (result == NULL)
     {
         fprintf(stderr, "I_OPL_RegisterSong: Failed to load MID.\n");
     }
 
-    // remove file now
-
-    M_remove(filename);
-    free(filename);
-
     return result;
 }
 
@@ -1821,6 +1811,25 @@ void I_SetOPLDriverVer(opl_driver_ver_t ver)
     opl_drv_ver = ver;
 }
 
+// [JN] CRL - offline rendering, used by -rendermusic. Render mode must be
+// set before the module is initialized, then time only advances as music
+// is generated by I_OPL_RenderMusic, as fast as it is called.
+
+void I_OPL_SetRenderMode(boolean render)
+{
+    OPL_SetRenderMode(render);
+}
+
+// Generate nsamples of 16-bit stereo music. Returns false once every
+// track of a song played without looping has ended.
+
+boolean I_OPL_RenderMusic(int16_t *buffer, int nsamples)
+{
+    OPL_Render(buffer, nsamples);
+
+    return running_tracks > 0;
+}
+
 //----------------------------------------------------------------------
 //
 // Development / debug message generation, to help developing GENMIDI
@@ -142,6 +142,9 @@ static boolean sdl_was_initialized = false;
 static boolean musicpaused = false;
 static int current_music_volume;
 
+// MIDI data of the registered song, read by SDL_mixer through RWops.
+static void *song_data = NULL;
+
 
 // Remove the temporary config file generated by I_InitTimidityConfig().
 
@@ -336,6 +339,9 @@ static void I_SDL_UnRegisterSong(void *handle)
     {
         Mix_FreeMusic(music);
     }
+
+    free(song_data);
+    song_data = NULL;
 }
 
 // Determine whether memory block is a .mid file 
@@ -345,24 +351,24 @@ static boolean IsMid(byte *mem, int len)
     return len > 4 && !memcmp(mem, "MThd", 4);
 }
 
-static boolean ConvertMus(byte *musdata, int len, const char *filename)
+// Convert MUS to MIDI, returning a malloc'ed copy of the result.
+
+static void *ConvertMus(byte *musdata, int len, size_t *midlen)
 {
     MEMFILE *instream;
     MEMFILE *outstream;
     void *outbuf;
-    size_t outbuf_len;
-    int result;
+    void *result = NULL;
 
     instream = mem_fopen_read(musdata, len);
     outstream = mem_fopen_write();
 
-    result = mus2mid(instream, outstream);
-
-    if (result == 0)
+    if (mus2mid(instream, outstream) == 0)
     {
-        mem_get_buf(outstream, &outbuf, &outbuf_len);
+        mem_get_buf(outstream, &outbuf, midlen);
 
-        M_WriteFile(filename, outbuf, outbuf_len);
+        result = malloc(*midlen);
+        memcpy(result, outbuf, *midlen);
     }
 
     mem_fclose(instream);
@@ -374,6 +380,8 @@ static boolean ConvertMus(byte *musdata, int len, const char *filename)
 static void *I_SDL_RegisterSong(void *data, int len)
 {
     char *filename;
+    void *mid;
+    size_t midlen;
     Mix_Music *music;
 
     if (!music_initialized)
@@ -384,43 +392,61 @@ static void *I_SDL_RegisterSong(void *data, int len)
     // MUS files begin with "MUS"
     // Reject anything which doesnt have this signature
 
-    filename = M_TempFile("doom.mid");
-
     if (IsMid(data, len) && len < MAXMIDLENGTH)
     {
-        M_WriteFile(filename, data, len);
         // [JN] CRL - Check if MIDI file is valid.
         MIDI_CheckFile(data, len);
+        midlen = len;
+        mid = malloc(midlen);
+        memcpy(mid, data, midlen);
     }
     else
     {
 	// Assume a MUS file and try to convert
 
-        ConvertMus(data, len, filename);
+        mid = ConvertMus(data, len, &midlen);
     }
 
-    // Load the MIDI. In an ideal world we'd be using Mix_LoadMUS_RW()
-    // by now, but Mix_SetMusicCMD() only works with Mix_LoadMUS(), so
-    // we have to generate a temporary file.
-
-    music = Mix_LoadMUS(filename);
-    if (music == NULL)
+    if (mid == NULL)
     {
-        // Failed to load
-        fprintf(stderr, "Error loading midi: %s\n", Mix_GetError());
+        fprintf(stderr, "Error loading midi: failed to convert MUS\n");
+        return NULL;
     }
 
-    // Remove the temporary MIDI file; however, when using an external
-    // MIDI program we can't delete the file. Otherwise, the program
-    // won't find the file to play. This means we leave a mess on
-    // disk :(
-
     if (strlen(snd_musiccmd) == 0)
     {
-        M_remove(filename);
+        // Load the MIDI straight from memory. SDL_mixer may keep
+        // reading from the RWops, so the data stays around until
+        // the song is unregistered.
+
+        music = Mix_LoadMUS_RW(SDL_RWFromConstMem(mid, midlen), SDL_TRUE);
+
+        if (music != NULL)
+        {
+            song_data = mid;
+            mid = NULL;
+        }
+    }
+    else
+    {
+        // Mix_SetMusicCMD() only works with Mix_LoadMUS(), so we have
+        // to generate a temporary file. We can't delete the file,
+        // otherwise the external program won't find it. This means
+        // we leave a mess on disk :(
+
+        filename = M_TempFile("doom.mid");
+        M_WriteFile(filename, mid, midlen);
+        music = Mix_LoadMUS(filename);
+        free(filename);
+    }
+
+    if (music == NULL)
+    {
+        // Failed to load
+        fprintf(stderr, "Error loading midi: %s\n", Mix_GetError());
     }
 
-    free(filename);
+    free(mid);
 
     return music;
 }
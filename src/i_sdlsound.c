@@ -72,6 +72,7 @@ struct allocated_sound_s
     int use_count;
     int pitch;
     allocated_sound_t *prev, *next;
+    allocated_sound_t *hash_next;
 };
 
 static boolean sound_initialized = false;
@@ -87,14 +88,55 @@ static boolean (*ExpandSoundData)(sfxinfo_t *sfxinfo,
                                   int samplerate,
                                   int length) = NULL;
 
-// Doubly-linked list of allocated sounds.
-// When a sound is played, it is moved to the head, so that the oldest
-// sounds not used recently are at the tail.
+// Doubly-linked list of allocated sounds which are not in use.
+// Sounds are taken out of the list while they are playing and put back
+// at the head when they stop, so that the oldest sounds not used
+// recently are at the tail and the tail can always be freed.
 
 static allocated_sound_t *allocated_sounds_head = NULL;
 static allocated_sound_t *allocated_sounds_tail = NULL;
 static int allocated_sounds_size = 0;
 
+// Hash table of all allocated sounds, in use or not, keyed by
+// sfxinfo and pitch.
+
+#define SOUND_HASH_SIZE 512
+
+static allocated_sound_t *allocated_sounds_hash[SOUND_HASH_SIZE];
+
+static unsigned int SoundHash(sfxinfo_t *sfxinfo, int pitch)
+{
+    uintptr_t key = (uintptr_t) sfxinfo;
+
+    key ^= key >> 9;
+    key += (unsigned int) pitch * 2654435761u;
+
+    return (unsigned int) (key ^ (key >> 16)) % SOUND_HASH_SIZE;
+}
+
+static void AllocatedSoundHash(allocated_sound_t *snd)
+{
+    allocated_sound_t **bucket;
+
+    bucket = &allocated_sounds_hash[SoundHash(snd->sfxinfo, snd->pitch)];
+    snd->hash_next = *bucket;
+    *bucket = snd;
+}
+
+static void AllocatedSoundUnhash(allocated_sound_t *snd)
+{
+    allocated_sound_t **p;
+
+    p = &allocated_sounds_hash[SoundHash(snd->sfxinfo, snd->pitch)];
+
+    while (*p != snd)
+    {
+        p = &(*p)->hash_next;
+    }
+
+    *p = snd->hash_next;
+}
+
 
 // Hook a sound into the linked list at the head.
 
@@ -138,11 +180,14 @@ static void AllocatedSoundUnlink(allocated_sound_t *snd)
     }
 }
 
+// Free a sound which is not in use.
+
 static void FreeAllocatedSound(allocated_sound_t *snd)
 {
-    // Unlink from linked list.
+    // Unlink from linked list and hash table.
 
     AllocatedSoundUnlink(snd);
+    AllocatedSoundUnhash(snd);
 
     // Keep track of the amount of allocated sound data:
 
@@ -151,30 +196,21 @@ static void FreeAllocatedSound(allocated_sound_t *snd)
     free(snd);
 }
 
-// Search from the tail backwards along the allocated sounds list, find
-// and free a sound that is not in use, to free up memory.  Return true
-// for success.
+// Free the least recently used sound that is not in use, to free up
+// memory.  Return true for success.
 
 static boolean FindAndFreeSound(void)
 {
-    allocated_sound_t *snd;
-
-    snd = allocated_sounds_tail;
-
-    while (snd != NULL)
+    if (allocated_sounds_tail == NULL)
     {
-        if (snd->use_count == 0)
-        {
-            FreeAllocatedSound(snd);
-            return true;
-        }
+        // No available sounds to free...
 
-        snd = snd->prev;
+        return false;
     }
 
-    // No available sounds to free...
+    FreeAllocatedSound(allocated_sounds_tail);
 
-    return false;
+    return true;
 }
 
 // Enforce SFX cache size limit.  We are just about to allocate "len"
@@ -204,7 +240,8 @@ static void ReserveCacheSpace(size_t len)
 
 // Allocate a block for a new sound effect.
 
-static allocated_sound_t *AllocateSound(sfxinfo_t *sfxinfo, size_t len)
+static allocated_sound_t *AllocateSound(sfxinfo_t *sfxinfo, int pitch,
+                                        size_t len)
 {
     allocated_sound_t *snd;
 
@@ -235,7 +272,7 @@ static allocated_sound_t *AllocateSound(sfxinfo_t *sfxinfo, size_t len)
     snd->chunk.alen = len;
     snd->chunk.allocated = 1;
     snd->chunk.volume = MIX_MAX_VOLUME;
-    snd->pitch = NORM_PITCH;
+    snd->pitch = pitch;
 
     snd->sfxinfo = sfxinfo;
     snd->use_count = 0;
@@ -245,6 +282,7 @@ static allocated_sound_t *AllocateSound(sfxinfo_t *sfxinfo, size_t len)
     allocated_sounds_size += len;
 
     AllocatedSoundLink(snd);
+    AllocatedSoundHash(snd);
 
     return snd;
 }
@@ -253,17 +291,18 @@ static allocated_sound_t *AllocateSound(sfxinfo_t *sfxinfo, size_t len)
 
 static void LockAllocatedSound(allocated_sound_t *snd)
 {
+    // Take the sound out of the list of sounds which can be freed.
+
+    if (snd->use_count == 0)
+    {
+        AllocatedSoundUnlink(snd);
+    }
+
     // Increase use count, to stop the sound being freed.
 
     ++snd->use_count;
 
     //printf("++ %s: Use count=%i\n", snd->sfxinfo->name, snd->use_count);
-
-    // When we use a sound, re-link it into the list at the head, so
-    // that the oldest sounds fall to the end of the list for freeing.
-
-    AllocatedSoundUnlink(snd);
-    AllocatedSoundLink(snd);
 }
 
 // Unlock a sound to indicate that it may now be freed.
@@ -278,14 +317,25 @@ static void UnlockAllocatedSound(allocated_sound_t *snd)
     --snd->use_count;
 
     //printf("-- %s: Use count=%i\n", snd->sfxinfo->name, snd->use_count);
+
+    // When the sound is no longer used, link it into the list at the
+    // head, so that the oldest sounds fall to the end of the list for
+    // freeing.
+
+    if (snd->use_count == 0)
+    {
+        AllocatedSoundLink(snd);
+    }
 }
 
-// Search through the list of allocated sounds and return the one that matches
-// the supplied sfxinfo entry and pitch level.
+// Look up the allocated sound that matches the supplied sfxinfo entry
+// and pitch level.
 
 static allocated_sound_t * GetAllocatedSoundBySfxInfoAndPitch(sfxinfo_t *sfxinfo, int pitch)
 {
-    allocated_sound_t * p = allocated_sounds_head;
+    allocated_sound_t * p;
+
+    p = allocated_sounds_hash[SoundHash(sfxinfo, pitch)];
 
     while (p != NULL)
     {
@@ -293,7 +343,7 @@ static allocated_sound_t * GetAllocatedSoundBySfxInfoAndPitch(sfxinfo_t *sfxinfo
         {
             return p;
         }
-        p = p->next;
+        p = p->hash_next;
     }
 
     return NULL;
@@ -305,9 +355,10 @@ static allocated_sound_t * GetAllocatedSoundBySfxInfoAndPitch(sfxinfo_t *sfxinfo
 static allocated_sound_t * PitchShift(allocated_sound_t *insnd, int pitch)
 {
     allocated_sound_t * outsnd;
-    Sint16 *inp, *outp;
+    Sint16 *outp;
     Sint16 *srcbuf, *dstbuf;
     Uint32 srclen, dstlen;
+    uint64_t pos, step;
 
     srcbuf = (Sint16 *)insnd->chunk.abuf;
     srclen = insnd->chunk.alen;
@@ -322,21 +373,22 @@ static allocated_sound_t * PitchShift(allocated_sound_t *insnd, int pitch)
         dstlen++;
     }
 
-    outsnd = AllocateSound(insnd->sfxinfo, dstlen);
+    outsnd = AllocateSound(insnd->sfxinfo, pitch, dstlen);
 
     if (!outsnd)
     {
         return NULL;
     }
 
-    outsnd->pitch = pitch;
     dstbuf = (Sint16 *)outsnd->chunk.abuf;
 
-    // loop over output buffer. find corresponding input cell, copy over
-    for (outp = dstbuf; outp < dstbuf + dstlen/2; ++outp)
+    // loop over output buffer, stepping through input in 32.32 fixed
+    // point by srclen:dstlen input cells per output cell
+    step = ((uint64_t) srclen << 32) / dstlen;
+
+    for (outp = dstbuf, pos = 0; outp < dstbuf + dstlen/2; ++outp, pos += step)
     {
-        inp = srcbuf + (int)((float)(outp - dstbuf) / dstlen * srclen);
-        *outp = *inp;
+        *outp = srcbuf[pos >> 32];
     }
 
     return outsnd;
@@ -361,9 +413,11 @@ static void ReleaseSoundOnChannel(int channel)
 
     UnlockAllocatedSound(snd);
 
-    // if the sound is a pitch-shift and it's not in use, immediately
-    // free it
-    if (snd->pitch != NORM_PITCH && snd->use_count <= 0)
+    // Pitch-shifted sounds stay cached for the next time the same
+    // pitch is rolled, and fall off the tail of the list when the cache
+    // is full. With no cache limit, free them as soon as they are not
+    // in use, so that they can't pile up.
+    if (snd_cachesize <= 0 && snd->pitch != NORM_PITCH && snd->use_count <= 0)
     {
         FreeAllocatedSound(snd);
     }
@@ -449,7 +503,7 @@ static boolean ExpandSoundData_SRC(sfxinfo_t *sfxinfo,
 
 //    alen = src_data.output_frames_gen * 4;
 
-    snd = AllocateSound(sfxinfo, src_data.output_frames_gen * 4);
+    snd = AllocateSound(sfxinfo, NORM_PITCH, src_data.output_frames_gen * 4);
 
     if (snd == NULL)
     {
@@ -623,7 +677,7 @@ static boolean ExpandSoundData_SDL(sfxinfo_t *sfxinfo,
 
     // Allocate a chunk in which to expand the sound
 
-    snd = AllocateSound(sfxinfo, expanded_length);
+    snd = AllocateSound(sfxinfo, NORM_PITCH, expanded_length);
 
     if (snd == NULL)
     {
@@ -967,9 +1021,12 @@ static int I_SDL_StartSound(sfxinfo_t *sfxinfo, int channel, int vol, int sep, i
             }
         }
     }
-    else
+    else if (pitch != NORM_PITCH)
     {
+        // A cached pitch-shifted variant plays instead of the base
+        // sound locked by LockSound, so move the lock over to it.
         LockAllocatedSound(snd);
+        UnlockAllocatedSound(GetAllocatedSoundBySfxInfoAndPitch(sfxinfo, NORM_PITCH));
     }
 
     // play sound
@@ -50,6 +50,10 @@ int snd_cachesize = 64 * 1024 * 1024;
 
 int snd_maxslicetime_ms = 28;
 
+// Mix sound effects with the native mixer instead of SDL_mixer channels.
+
+int snd_nativemixer = 0;
+
 // External command to invoke to play back music.
 
 char *snd_musiccmd = "";
@@ -86,6 +90,7 @@ static int snd_mport = 816;
 static const sound_module_t *sound_modules[] =
 {
 #ifndef DISABLE_SDL2MIXER
+    &sound_mix_module,
     &sound_sdl_module,
 #endif // DISABLE_SDL2MIXER
     &sound_pcsound_module,
@@ -268,6 +273,17 @@ void I_ShutdownSound(void)
     }
 }
 
+// [JN] True if sound effects are played by the native mixer.
+
+boolean I_NativeMixerActive(void)
+{
+#ifndef DISABLE_SDL2MIXER
+    return sound_module == &sound_mix_module;
+#else
+    return false;
+#endif
+}
+
 int I_GetSfxLumpNum(sfxinfo_t *sfxinfo)
 {
     if (sound_module != NULL)
@@ -460,6 +476,7 @@ void I_BindSoundVariables(void)
     M_BindStringVariable("snd_dmxoption",        &snd_dmxoption);
     M_BindIntVariable("snd_samplerate",          &snd_samplerate);
     M_BindIntVariable("snd_cachesize",           &snd_cachesize);
+    M_BindIntVariable("snd_nativemixer",         &snd_nativemixer);
     M_BindIntVariable("opl_io_port",             &opl_io_port);
     M_BindIntVariable("snd_pitchshift",          &snd_pitchshift);
 
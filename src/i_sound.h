@@ -165,6 +165,13 @@ void I_StopSound(int channel);
 boolean I_SoundIsPlaying(int channel);
 void I_PrecacheSounds(sfxinfo_t *sounds, int num_sounds);
 
+// [JN] Most sound effects the native mixer can play at once. Games
+// allow this many channels while it is the active sound module.
+
+#define MAX_MIX_VOICES 64
+
+boolean I_NativeMixerActive(void);
+
 // Interface for music modules
 
 typedef struct
@@ -236,6 +243,7 @@ extern int snd_musicdevice;
 extern int snd_samplerate;
 extern int snd_cachesize;
 extern int snd_maxslicetime_ms;
+extern int snd_nativemixer;
 extern char *snd_musiccmd;
 extern int snd_pitchshift;
 extern char *snd_dmxoption;
@@ -253,10 +261,13 @@ typedef enum {
 
 void I_SetOPLDriverVer(opl_driver_ver_t ver);
 void I_OPL_DevMessages(char *, size_t);
+void I_OPL_SetRenderMode(boolean render);
+boolean I_OPL_RenderMusic(int16_t *buffer, int nsamples);
 
 // Sound modules
 
 void I_InitTimidityConfig(void);
+extern const sound_module_t sound_mix_module;
 extern const sound_module_t sound_sdl_module;
 extern const sound_module_t sound_pcsound_module;
 extern const music_module_t music_sdl_module;
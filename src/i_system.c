@@ -66,6 +66,9 @@ struct atexit_listentry_s
 
 static atexit_listentry_t *exit_funcs = NULL;
 
+// [JN] Set by I_QuietErrorExit.
+static boolean quiet_error_exit = false;
+
 void I_AtExit(atexit_func_t func, boolean run_on_error)
 {
     atexit_listentry_t *entry;
@@ -78,6 +81,19 @@ void I_AtExit(atexit_func_t func, boolean run_on_error)
     exit_funcs = entry;
 }
 
+//
+// I_QuietErrorExit
+// [JN] Called by forked worker processes. Exit functions belong to the
+// parent (one of them saves the config file), and neither they, a popup
+// nor SDL_Quit must run in every failing child at once.
+//
+
+void I_QuietErrorExit(void)
+{
+    exit_funcs = NULL;
+    quiet_error_exit = true;
+}
+
 // Zone memory auto-allocation function that allocates the zone size
 // by trying progressively smaller zone sizes until one is found that
 // works.
@@ -295,6 +311,13 @@ void I_Error (const char *error, ...)
     M_vsnprintf(msgbuf, sizeof(msgbuf), error, argptr);
     va_end(argptr);
 
+#ifndef _WIN32
+    if (quiet_error_exit)
+    {
+        _exit(-1);
+    }
+#endif
+
     // Shutdown. Here might be other errors.
 
     entry = exit_funcs;
@@ -66,6 +66,11 @@ boolean I_GetMemoryValue(unsigned int offset, void *value, int size);
 
 void I_AtExit(atexit_func_t func, boolean run_if_error);
 
+// [JN] For forked worker processes: I_Error only prints the message
+// and leaves with _exit, without exit functions or an error popup.
+
+void I_QuietErrorExit(void);
+
 // Add all system-specific config file variable bindings.
 
 void I_BindVariables(void);
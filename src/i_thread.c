@@ -0,0 +1,156 @@
+//
+// Copyright(C) 2018-2024 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Pool of worker threads for parallel drawing.
+//
+
+
+#include "SDL.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "i_system.h"
+#include "i_thread.h"
+#include "m_misc.h"
+
+
+typedef struct
+{
+    SDL_Thread *thread;
+    SDL_sem    *start;
+    int         job;
+} worker_t;
+
+static worker_t     workers[MAXWORKERJOBS];
+static int          numworkers;
+static SDL_sem     *workers_done;
+static workerfunc_t workers_func;
+static int          workers_numjobs;
+
+#ifndef _WIN32
+// Process the threads were started in. A forked child inherits the
+// pool's state, but none of its threads.
+static pid_t        workers_pid;
+#endif
+
+static int WorkerThread (void *data)
+{
+    worker_t *worker = data;
+
+    while (1)
+    {
+        SDL_SemWait(worker->start);
+        workers_func(worker->job, workers_numjobs);
+        SDL_SemPost(workers_done);
+    }
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// StartWorkers
+//  Creates worker threads, up to given number of jobs.
+//  Job 0 always goes to the calling thread, so it has no worker.
+// -----------------------------------------------------------------------------
+
+static void StartWorkers (int numjobs)
+{
+#ifndef _WIN32
+    // Forked since the threads were started (as -limitscan and
+    // -verifydemos workers are)? Start new ones for this process.
+    if (workers_done != NULL && workers_pid != getpid())
+    {
+        workers_done = NULL;
+    }
+#endif
+
+    if (workers_done == NULL)
+    {
+        workers_done = SDL_CreateSemaphore(0);
+        numworkers = 1;
+#ifndef _WIN32
+        workers_pid = getpid();
+#endif
+    }
+
+    while (numworkers < numjobs)
+    {
+        worker_t *worker = &workers[numworkers];
+        char name[16];
+
+        M_snprintf(name, sizeof(name), "worker%d", numworkers);
+
+        worker->job = numworkers;
+        worker->start = SDL_CreateSemaphore(0);
+        worker->thread = SDL_CreateThread(WorkerThread, name, worker);
+
+        if (worker->thread == NULL)
+        {
+            I_Error("StartWorkers: failed to create thread: %s",
+                    SDL_GetError());
+        }
+
+        SDL_DetachThread(worker->thread);
+        numworkers++;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// I_RunWorkers
+//  Runs func as numjobs parallel jobs and waits for all of them.
+// -----------------------------------------------------------------------------
+
+void I_RunWorkers (workerfunc_t func, int numjobs)
+{
+    int i;
+
+    if (numjobs > MAXWORKERJOBS)
+    {
+        numjobs = MAXWORKERJOBS;
+    }
+
+    if (numjobs <= 1)
+    {
+        func(0, 1);
+        return;
+    }
+
+    StartWorkers(numjobs);
+
+    workers_func = func;
+    workers_numjobs = numjobs;
+
+    for (i = 1; i < numjobs; i++)
+    {
+        SDL_SemPost(workers[i].start);
+    }
+
+    func(0, numjobs);
+
+    for (i = 1; i < numjobs; i++)
+    {
+        SDL_SemWait(workers_done);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// I_GetCPUCount
+// -----------------------------------------------------------------------------
+
+int I_GetCPUCount (void)
+{
+    return SDL_GetCPUCount();
+}
@@ -0,0 +1,35 @@
+//
+// Copyright(C) 2018-2024 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Pool of worker threads for parallel drawing.
+//
+
+
+#ifndef __I_THREAD__
+#define __I_THREAD__
+
+// Maximum number of jobs that can run at once, including calling thread.
+#define MAXWORKERJOBS 16
+
+// Job function, called with job number in [0, numjobs).
+typedef void (*workerfunc_t)(int job, int numjobs);
+
+// Runs func as numjobs parallel jobs and waits for all of them to finish.
+// Job 0 is run by the calling thread.
+void I_RunWorkers(workerfunc_t func, int numjobs);
+
+// Number of logical CPU cores, for sizing job counts.
+int I_GetCPUCount(void);
+
+#endif
@@ -87,6 +87,13 @@ static uint32_t pixel_format;
 static SDL_Color palette[256];
 static boolean palette_to_set;
 
+// [JN] Palette converted to the pixel format of intermediate texture.
+// If texture uses 32-bit pixels, the paletted screen buffer is expanded
+// straight into the locked texture, skipping SDL blit and RGBA buffer copy.
+
+static uint32_t palette_lut[256];
+static boolean native_blit;
+
 // display has been set up?
 
 static boolean initialized = false;
@@ -792,6 +799,59 @@ static void CreateUpscaledTexture(boolean force)
     }
 }
 
+// -----------------------------------------------------------------------------
+// UpdatePaletteLUT
+//  [JN] Converts current palette to the pixel format of intermediate texture.
+// -----------------------------------------------------------------------------
+
+static void UpdatePaletteLUT (void)
+{
+    int i;
+
+    if (argbbuffer == NULL)
+    {
+        return;
+    }
+
+    for (i = 0 ; i < 256 ; ++i)
+    {
+        palette_lut[i] = SDL_MapRGB(argbbuffer->format,
+                                    palette[i].r, palette[i].g, palette[i].b);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// ExpandScreenBuffer
+//  [JN] Expands paletted screen buffer into 32-bit pixels using palette LUT.
+//  Eight pixels are read at once and written as independent stores,
+//  so the loop is not bound by the latency of table lookups.
+// -----------------------------------------------------------------------------
+
+static void ExpandScreenBuffer (void *dest, const int dest_pitch)
+{
+    const uint32_t *const lut = palette_lut;
+    int x, y;
+
+    for (y = 0 ; y < SCREENHEIGHT ; y++)
+    {
+        const byte *src = (const byte *) screenbuffer->pixels
+                        + y * screenbuffer->pitch;
+        uint32_t *dst = (uint32_t *) ((byte *) dest + y * dest_pitch);
+
+        for (x = 0 ; x < SCREENWIDTH ; x += 8)
+        {
+            dst[x + 0] = lut[src[x + 0]];
+            dst[x + 1] = lut[src[x + 1]];
+            dst[x + 2] = lut[src[x + 2]];
+            dst[x + 3] = lut[src[x + 3]];
+            dst[x + 4] = lut[src[x + 4]];
+            dst[x + 5] = lut[src[x + 5]];
+            dst[x + 6] = lut[src[x + 6]];
+            dst[x + 7] = lut[src[x + 7]];
+        }
+    }
+}
+
 //
 // I_FinishUpdate
 //
@@ -897,6 +957,22 @@ void I_FinishUpdate (void)
         }
     }
 
+    if (native_blit)
+    {
+        void *pixels;
+        int pitch;
+
+        // Expand the paletted 8-bit screen buffer right into the
+        // intermediate texture.
+
+        if (SDL_LockTexture(texture, NULL, &pixels, &pitch) == 0)
+        {
+            ExpandScreenBuffer(pixels, pitch);
+            SDL_UnlockTexture(texture);
+        }
+    }
+    else
+    {
     // Blit from the paletted 8-bit screen buffer to the intermediate
     // 32-bit RGBA buffer that we can load into the texture.
 
@@ -905,6 +981,7 @@ void I_FinishUpdate (void)
     // Update the intermediate texture with the contents of the RGBA buffer.
 
     SDL_UpdateTexture(texture, NULL, argbbuffer->pixels, argbbuffer->pitch);
+    }
 
     // Make sure the pillarboxes are kept clear each frame.
 
@@ -933,38 +1010,45 @@ void I_FinishUpdate (void)
 
     SDL_RenderPresent(renderer);
 
-    if (crl_uncapped_fps && !singletics)
-    {
-        // Limit framerate
-        if (crl_fpslimit >= TICRATE)
-        {
-            uint64_t target_time = 1000000ull / crl_fpslimit;
-            static uint64_t start_time;
+    // Restore background and undo the disk indicator, if it was drawn.
+    V_RestoreDiskBackground();
+}
 
-            while (1)
-            {
-                uint64_t current_time = I_GetTimeUS();
-                uint64_t elapsed_time = current_time - start_time;
-                uint64_t remaining_time = 0;
+// -----------------------------------------------------------------------------
+// I_FrameDue
+//  [JN] Framerate limiter. Returns false if it is too early to draw the next
+//  frame. Instead of sleeping until the frame is due, only a short nap is
+//  taken, so the main loop keeps running tics, reading input and updating
+//  sounds while waiting.
+// -----------------------------------------------------------------------------
 
-                if (elapsed_time >= target_time)
-                {
-                    start_time = current_time;
-                    break;
-                }
+boolean I_FrameDue (void)
+{
+    static uint64_t start_time;
+    uint64_t target_time, current_time, elapsed_time;
 
-                remaining_time = target_time - elapsed_time;
+    if (!crl_uncapped_fps || singletics || crl_fpslimit < TICRATE)
+    {
+        return true;
+    }
 
-                if (remaining_time > 1000)
-                {
-                    I_Sleep((remaining_time - 1000) / 1000);
-                }
-            }
-        }
+    target_time = 1000000ull / crl_fpslimit;
+    current_time = I_GetTimeUS();
+    elapsed_time = current_time - start_time;
+
+    if (elapsed_time >= target_time)
+    {
+        start_time = current_time;
+        return true;
     }
 
-    // Restore background and undo the disk indicator, if it was drawn.
-    V_RestoreDiskBackground();
+    // Busy-wait the last millisecond for precise pacing.
+    if (target_time - elapsed_time > 1000)
+    {
+        I_Sleep(1);
+    }
+
+    return false;
 }
 
 
@@ -1040,6 +1124,7 @@ void I_SetPalette (byte *doompalette)
         }
     }
 
+    UpdatePaletteLUT();
     palette_to_set = true;
 }
 
@@ -1556,6 +1641,11 @@ static void SetVideoMode(void)
         SDL_FillRect(argbbuffer, NULL, 0);
     }
 
+    // [JN] Use native palette conversion if texture has 32-bit pixels.
+
+    native_blit = (SDL_BYTESPERPIXEL(pixel_format) == 4);
+    UpdatePaletteLUT();
+
     if (texture != NULL)
     {
         SDL_DestroyTexture(texture);
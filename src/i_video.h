@@ -55,6 +55,7 @@ void I_SetPalette (byte* palette);
 int I_GetPaletteIndex(int r, int g, int b);
 
 void I_FinishUpdate (void);
+boolean I_FrameDue (void);
 
 void I_ReadScreen (pixel_t* scr);
 
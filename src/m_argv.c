@@ -73,6 +73,26 @@ boolean M_ParmExists(const char *check)
     return M_CheckParm(check) != 0;
 }
 
+//
+// M_AddParm
+// Appends parameter to the end of command line, if not there already.
+//
+
+void M_AddParm(const char *parm)
+{
+    char **args;
+
+    if (M_ParmExists(parm))
+    {
+        return;
+    }
+
+    args = malloc((myargc + 1) * sizeof(*args));
+    memcpy(args, myargv, myargc * sizeof(*args));
+    args[myargc++] = M_StringDuplicate(parm);
+    myargv = args;
+}
+
 int M_CheckParm(const char *check)
 {
     return M_CheckParmWithArgs(check, 0);
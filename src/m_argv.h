@@ -48,6 +48,10 @@ void M_AddLooseFiles(void);
 
 boolean M_ParmExists(const char *check);
 
+// Append parameter to command line, if not there already.
+
+void M_AddParm(const char *parm);
+
 // Get name of executable used to run this program:
 
 const char *M_GetExecutableName(void);
@@ -231,6 +231,7 @@ static default_t	doom_defaults_list[] =
     CONFIG_VARIABLE_INT(snd_samplerate),
     CONFIG_VARIABLE_INT(snd_cachesize),
     CONFIG_VARIABLE_INT(snd_maxslicetime_ms),
+    CONFIG_VARIABLE_INT(snd_nativemixer),
     CONFIG_VARIABLE_INT(snd_pitchshift),
     CONFIG_VARIABLE_STRING(snd_musiccmd),
     CONFIG_VARIABLE_STRING(snd_dmxoption),
@@ -420,6 +421,7 @@ static default_t	doom_defaults_list[] =
     CONFIG_VARIABLE_KEY(key_crl_demospeed),
     CONFIG_VARIABLE_KEY(key_crl_extendedhud),
     CONFIG_VARIABLE_KEY(key_crl_limits),
+    CONFIG_VARIABLE_KEY(key_crl_rewind),
 
     CONFIG_VARIABLE_KEY(key_crl_mlook),
 
@@ -440,6 +442,7 @@ static default_t	doom_defaults_list[] =
     CONFIG_VARIABLE_INT(crl_screenwipe),
     CONFIG_VARIABLE_INT(crl_text_shadows),
     CONFIG_VARIABLE_INT(crl_colorblind),
+    CONFIG_VARIABLE_INT(crl_plane_threads),
 
     // Widgets
     CONFIG_VARIABLE_INT(crl_extended_hud),
@@ -470,6 +473,7 @@ static default_t	doom_defaults_list[] =
     CONFIG_VARIABLE_INT(crl_revealed_secrets),
     CONFIG_VARIABLE_INT(crl_restore_targets),
     CONFIG_VARIABLE_INT(crl_death_use_action),
+    CONFIG_VARIABLE_INT(crl_rewind_interval),
 
     // Demos
     CONFIG_VARIABLE_INT(crl_demo_timer),
@@ -249,6 +249,7 @@ int key_crl_demospeed = 0; // [crispy]
 int key_crl_extendedhud = 0;
 
 int key_crl_limits = 0;
+int key_crl_rewind = 0;
 
 int key_crl_mlook = 0; // [crispy]
 
@@ -428,6 +429,7 @@ void M_BindMenuControls(void)
     M_BindIntVariable("key_crl_extendedhud", &key_crl_extendedhud);
 
     M_BindIntVariable("key_crl_limits",      &key_crl_limits);
+    M_BindIntVariable("key_crl_rewind",      &key_crl_rewind);
 
     M_BindIntVariable("key_crl_mlook",       &key_crl_mlook); // [crispy]
 }
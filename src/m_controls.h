@@ -216,6 +216,7 @@ extern int key_crl_demospeed; // [crispy]
 extern int key_crl_extendedhud;
 
 extern int key_crl_limits;
+extern int key_crl_rewind;
 
 extern int key_crl_mlook; // [crispy]
 
@@ -196,6 +196,10 @@ boolean MIDI_CheckFile(void *data, int len);
 
 midi_file_t *MIDI_LoadFile(char *filename);
 
+// Load a MIDI file from a buffer in memory.
+
+midi_file_t *MIDI_LoadFromMemory(void *data, int len);
+
 // Free a MIDI file.
 
 void MIDI_FreeFile(midi_file_t *file);
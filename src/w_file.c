@@ -44,6 +44,18 @@ wad_file_t *W_OpenFile(const char *path)
     wad_file_t *result;
     int i;
 
+#ifdef HAVE_MMAP
+    //!
+    // @category obscure
+    //
+    // Do not map WAD files into memory, read lumps into the zone instead.
+    //
+
+    if (M_ParmExists("-nommap"))
+    {
+        return stdc_wad_file.OpenFile(path);
+    }
+#else
     //!
     // @category obscure
     //
@@ -55,6 +67,7 @@ wad_file_t *W_OpenFile(const char *path)
     {
         return stdc_wad_file.OpenFile(path);
     }
+#endif
 
     // Try all classes in order until we find one that works
 
@@ -84,3 +97,11 @@ size_t W_Read(wad_file_t *wad, unsigned int offset,
     return wad->file_class->Read(wad, offset, buffer, buffer_len);
 }
 
+void W_Prefetch(wad_file_t *wad, unsigned int offset, size_t len)
+{
+    if (wad->file_class->Prefetch != NULL)
+    {
+        wad->file_class->Prefetch(wad, offset, len);
+    }
+}
+
@@ -39,6 +39,11 @@ typedef struct
     // provided buffer.  Returns the number of bytes read.
     size_t (*Read)(wad_file_t *file, unsigned int offset,
                    void *buffer, size_t buffer_len);
+
+    // Hint that the specified range of a mapped file is about to be
+    // read. May be NULL if the class has no way to do this.
+    void (*Prefetch)(wad_file_t *file, unsigned int offset,
+                     size_t len);
 } wad_file_class_t;
 
 
@@ -85,4 +90,8 @@ void W_CloseFile(wad_file_t *wad);
 size_t W_Read(wad_file_t *wad, unsigned int offset,
               void *buffer, size_t buffer_len);
 
+// Hint that the specified range of the file will be read soon.
+
+void W_Prefetch(wad_file_t *wad, unsigned int offset, size_t len);
+
 #endif /* #ifndef __W_FILE__ */
@@ -45,15 +45,10 @@ static void MapFile(posix_wad_file_t *wad, const char *filename)
     int protection;
     int flags;
 
-    // Mapped area can be read and written to.  Ideally
-    // this should be read-only, as none of the Doom code should 
-    // change the WAD files after being read.  However, there may
-    // be code lurking in the source that does.
+    // Mapped area is read-only, none of the game code changes
+    // lumps returned by W_CacheLumpNum in place.
 
-    protection = PROT_READ|PROT_WRITE;
-
-    // Writes to the mapped area result in private changes that are
-    // *not* written to disk.
+    protection = PROT_READ;
 
     flags = MAP_PRIVATE;
 
@@ -165,12 +160,45 @@ size_t W_POSIX_Read(wad_file_t *wad, unsigned int offset,
     return bytes_read;
 }
 
+// Ask the kernel to start reading the pages of the specified
+// range in the background.
+
+static void W_POSIX_Prefetch(wad_file_t *wad, unsigned int offset,
+                             size_t len)
+{
+    static long pagesize = 0;
+    unsigned int start;
+
+    if (wad->mapped == NULL || len == 0)
+    {
+        return;
+    }
+
+    if (pagesize == 0)
+    {
+        pagesize = sysconf(_SC_PAGESIZE);
+
+        if (pagesize <= 0)
+        {
+            pagesize = 4096;
+        }
+    }
+
+    // The start address must be page aligned.
+
+    start = offset - offset % pagesize;
+
+    posix_madvise(wad->mapped + start, len + (offset - start),
+                  POSIX_MADV_WILLNEED);
+}
+
 
 wad_file_class_t posix_wad_file = 
 {
     W_POSIX_OpenFile,
     W_POSIX_CloseFile,
     W_POSIX_Read,
+    W_POSIX_Prefetch,
 };
 
 
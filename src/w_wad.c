@@ -26,12 +26,20 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "config.h"
+
+#ifdef HAVE_INOTIFY
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
 #include "doomtype.h"
 
 #include "i_swap.h"
 #include "i_system.h"
 #include "i_video.h"
 #include "m_misc.h"
+#include "sha1.h"
 #include "v_diskicon.h"
 #include "z_zone.h"
 
@@ -56,6 +64,64 @@ static lumpinfo_t *reloadlumps = NULL;
 static char *reloadname = NULL;
 static int reloadlump = -1;
 
+// [JN] What stat() told about the reload file when it was last read, so
+// that an untouched file doesn't have to be read again. Sub-second times,
+// inode and change time are kept too, since an editor may save a file of
+// the same size within the same second.
+typedef struct
+{
+    time_t mtime;
+    long mtimensec;
+    time_t ctime;
+    long long size;
+    unsigned long long ino;
+} reloadstat_t;
+
+static reloadstat_t reloadstat;
+
+// [JN] SHA1 of every non-map lump of the reload file, so that resource
+// lumps edited without changing their size are noticed too.
+static sha1_digest_t *reloadsums;
+
+// [JN] Watching the reload file for changes: what the last check saw,
+// checks left until the next one, and the inotify descriptor, if any.
+// When inotify has reported a write, the next reload doesn't trust stat()
+// and lets the lump checksums decide what has changed.
+static reloadstat_t reloadseenstat;
+static int reloadpoll;
+static int reloadwatch = -1;
+static boolean reloadwritten;
+
+// [JN] Fills in reload file details, returns false if it can't be stat'ed.
+
+static boolean W_StatReloadFile(reloadstat_t *rs)
+{
+    struct stat st;
+
+    memset(rs, 0, sizeof(*rs));
+
+    if (M_stat(reloadname + 1, &st) != 0)
+    {
+        return false;
+    }
+
+    rs->mtime = st.st_mtime;
+#ifdef HAVE_STAT_MTIM
+    rs->mtimensec = st.st_mtim.tv_nsec;
+#endif
+    rs->ctime = st.st_ctime;
+    rs->size = st.st_size;
+    rs->ino = st.st_ino;
+
+    return true;
+}
+
+static boolean W_SameReloadStat(const reloadstat_t *a, const reloadstat_t *b)
+{
+    return a->mtime == b->mtime && a->mtimensec == b->mtimensec
+        && a->ctime == b->ctime && a->size == b->size && a->ino == b->ino;
+}
+
 static char **wad_filenames;
 
 static void AddWADFileName(const char *filename)
@@ -94,53 +160,18 @@ unsigned int W_LumpNameHash(const char *s)
 //
 
 //
-// W_AddFile
-// All files are optional, but at least one file must be
-//  found (PWAD, if all required lumps are present).
-// Files with a .wad extension are wadlink files
-//  with multiple lumps.
-// Other files are single lumps with the base filename
-//  for the lump name.
+// W_ReadDirectory
+// [JN] Reads the lump directory of an opened file, or makes up
+// a one-lump directory for single lump files. The returned
+// directory must be freed with Z_Free.
+//
 
-wad_file_t *W_AddFile (const char *filename)
+static filelump_t *W_ReadDirectory (wad_file_t *wad_file, const char *filename,
+                                    int *numfilelumps)
 {
     wadinfo_t header;
-    lumpindex_t i;
-    wad_file_t *wad_file;
     int length;
-    int startlump;
     filelump_t *fileinfo;
-    filelump_t *filerover;
-    lumpinfo_t *filelumps;
-    int numfilelumps;
-
-    // If the filename begins with a ~, it indicates that we should use the
-    // reload hack.
-    if (filename[0] == '~')
-    {
-        if (reloadname != NULL)
-        {
-            I_Error("Prefixing a WAD filename with '~' indicates that the "
-                    "WAD should be reloaded\n"
-                    "on each level restart, for use by level authors for "
-                    "rapid development. You\n"
-                    "can only reload one WAD file, and it must be the last "
-                    "file in the -file list.");
-        }
-
-        reloadname = strdup(filename);
-        reloadlump = numlumps;
-        ++filename;
-    }
-
-    // Open the file and add to directory
-    wad_file = W_OpenFile(filename);
-
-    if (wad_file == NULL)
-    {
-	printf (" couldn't open %s\n", filename);
-	return NULL;
-    }
 
     if (strcasecmp(filename+strlen(filename)-3 , "wad" ) )
     {
@@ -159,7 +190,7 @@ wad_file_t *W_AddFile (const char *filename)
         // extension).
 
 	M_ExtractFileBase (filename, fileinfo->name);
-	numfilelumps = 1;
+	*numfilelumps = 1;
     }
     else
     {
@@ -195,9 +226,25 @@ wad_file_t *W_AddFile (const char *filename)
 	fileinfo = Z_Malloc(length, PU_STATIC, 0);
 
         W_Read(wad_file, header.infotableofs, fileinfo, length);
-	numfilelumps = header.numlumps;
+	*numfilelumps = header.numlumps;
     }
 
+    return fileinfo;
+}
+
+//
+// W_AddLumps
+// [JN] Appends the lumps of a directory to lumpinfo.
+//
+
+static lumpinfo_t *W_AddLumps (wad_file_t *wad_file, filelump_t *fileinfo,
+                               int numfilelumps)
+{
+    lumpindex_t i;
+    int startlump;
+    filelump_t *filerover;
+    lumpinfo_t *filelumps;
+
     // Increase size of numlumps array to accomodate the new file.
     filelumps = calloc(numfilelumps, sizeof(lumpinfo_t));
     if (filelumps == NULL)
@@ -224,6 +271,128 @@ wad_file_t *W_AddFile (const char *filename)
         ++filerover;
     }
 
+    return filelumps;
+}
+
+// [JN] Tells map lumps apart from resource lumps in the reload file.
+static boolean W_IsMapLump (const lumpinfo_t *const *lumps, int num, int i)
+{
+    static const char *const maplumps[] = {
+        "THINGS", "LINEDEFS", "SIDEDEFS", "VERTEXES", "SEGS",
+        "SSECTORS", "NODES", "SECTORS", "REJECT", "BLOCKMAP", "BEHAVIOR",
+    };
+    size_t j;
+
+    // Map marker, followed by the map lumps.
+    if (i + 1 < num && !strncasecmp(lumps[i + 1]->name, "THINGS", 8))
+    {
+        return true;
+    }
+
+    for (j = 0; j < arrlen(maplumps); ++j)
+    {
+        if (!strncasecmp(lumps[i]->name, maplumps[j], 8))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// [JN] The reload file is rewritten by the level editor while the game
+// runs, and pointers to its lumps may outlive the file, so it is never
+// memory-mapped: its lumps are always read into the zone.
+static wad_file_t *W_OpenWADFile (const char *path)
+{
+    if (reloadname != NULL && !strcmp(path, reloadname + 1))
+    {
+        return stdc_wad_file.OpenFile(path);
+    }
+
+    return W_OpenFile(path);
+}
+
+// [JN] SHA1 of a lump's contents, read straight from its file.
+static void W_HashLump (const lumpinfo_t *lump, sha1_digest_t digest)
+{
+    sha1_context_t context;
+    byte *data = malloc(lump->size + 1);
+
+    W_Read(lump->wad_file, lump->position, data, lump->size);
+
+    SHA1_Init(&context);
+    SHA1_Update(&context, data, lump->size);
+    SHA1_Final(digest, &context);
+
+    free(data);
+}
+
+// [JN] Hashes every resource lump of the reload file as it is now.
+static void W_HashReloadLumps (void)
+{
+    const int num = numlumps - reloadlump;
+    int i;
+
+    free(reloadsums);
+    reloadsums = calloc(num + 1, sizeof(*reloadsums));
+
+    for (i = 0; i < num; ++i)
+    {
+        if (!W_IsMapLump((const lumpinfo_t *const *) lumpinfo + reloadlump,
+                         num, i))
+        {
+            W_HashLump(&reloadlumps[i], reloadsums[i]);
+        }
+    }
+}
+
+//
+// W_AddFile
+// All files are optional, but at least one file must be
+//  found (PWAD, if all required lumps are present).
+// Files with a .wad extension are wadlink files
+//  with multiple lumps.
+// Other files are single lumps with the base filename
+//  for the lump name.
+
+wad_file_t *W_AddFile (const char *filename)
+{
+    wad_file_t *wad_file;
+    filelump_t *fileinfo;
+    lumpinfo_t *filelumps;
+    int numfilelumps;
+
+    // If the filename begins with a ~, it indicates that we should use the
+    // reload hack.
+    if (filename[0] == '~')
+    {
+        if (reloadname != NULL)
+        {
+            I_Error("Prefixing a WAD filename with '~' indicates that the "
+                    "WAD should be reloaded\n"
+                    "on each level restart, for use by level authors for "
+                    "rapid development. You\n"
+                    "can only reload one WAD file, and it must be the last "
+                    "file in the -file list.");
+        }
+
+        reloadname = strdup(filename);
+        reloadlump = numlumps;
+        ++filename;
+    }
+
+    // Open the file and add to directory
+    wad_file = W_OpenWADFile(filename);
+
+    if (wad_file == NULL)
+    {
+	printf (" couldn't open %s\n", filename);
+	return NULL;
+    }
+
+    fileinfo = W_ReadDirectory(wad_file, filename, &numfilelumps);
+    filelumps = W_AddLumps(wad_file, fileinfo, numfilelumps);
     Z_Free(fileinfo);
 
     if (lumphash != NULL)
@@ -238,6 +407,30 @@ wad_file_t *W_AddFile (const char *filename)
     {
         reloadhandle = wad_file;
         reloadlumps = filelumps;
+        W_HashReloadLumps();
+
+        W_StatReloadFile(&reloadstat);
+        reloadseenstat = reloadstat;
+
+#ifdef HAVE_INOTIFY
+        // Watch the directory rather than the file, editors often save
+        // by writing a new file and renaming it over the old one.
+        reloadwatch = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+        if (reloadwatch >= 0)
+        {
+            char *dir = M_DirName(filename);
+
+            if (inotify_add_watch(reloadwatch, dir,
+                                  IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+            {
+                close(reloadwatch);
+                reloadwatch = -1;
+            }
+
+            free(dir);
+        }
+#endif
     }
 
     AddWADFileName(filename);
@@ -491,6 +684,31 @@ void W_ReleaseLumpName(const char *name)
     W_ReleaseLumpNum(W_GetNumForName(name));
 }
 
+//
+// W_PrefetchLumpNum
+//
+// [JN] Hint that a lump in a memory-mapped file is about to be used,
+// so its pages can be read in the background. Does nothing for lumps
+// in ordinary files.
+//
+
+void W_PrefetchLumpNum(lumpindex_t lumpnum)
+{
+    lumpinfo_t *lump;
+
+    if ((unsigned)lumpnum >= numlumps)
+    {
+	I_Error ("W_PrefetchLumpNum: %i >= numlumps", lumpnum);
+    }
+
+    lump = lumpinfo[lumpnum];
+
+    if (lump->wad_file->mapped != NULL)
+    {
+        W_Prefetch(lump->wad_file, lump->position, lump->size);
+    }
+}
+
 #if 0
 
 //
@@ -601,16 +819,52 @@ void W_GenerateHashTable(void)
 // incremental changes to the level you're working on without having to restart
 // the game after every change.
 // But: the reload feature is a fragile hack...
-void W_Reload(void)
+// [JN] Only rereads the file if it has been written since it was last
+// read. If its lumps have kept their names and order, the existing lump
+// entries and hash table are updated in place. Returns W_RELOAD_RESOURCES
+// if lumps other than maps may have changed, so the caller knows whether
+// data built from them is still valid.
+
+int W_Reload(void)
 {
     char *filename;
     lumpindex_t i;
+    reloadstat_t rs;
+    boolean statok;
+    wad_file_t *wad_file;
+    filelump_t *fileinfo;
+    int numfilelumps;
+    int result = W_RELOAD_MAPS;
 
     if (reloadname == NULL)
     {
-        return;
+        return W_RELOAD_NONE;
     }
 
+    filename = reloadname + 1;
+    statok = W_StatReloadFile(&rs);
+
+    if (statok && !reloadwritten && W_SameReloadStat(&rs, &reloadstat))
+    {
+        return W_RELOAD_NONE;
+    }
+
+    wad_file = W_OpenWADFile(filename);
+
+    if (wad_file == NULL)
+    {
+        // Probably in the middle of being saved, keep what we have.
+        printf("W_Reload: couldn't open %s\n", filename);
+        return W_RELOAD_NONE;
+    }
+
+    // If the file can't be stat'ed, forget what was seen before, so that
+    // it is read again next time.
+    reloadstat = rs;
+    reloadwritten = false;
+
+    fileinfo = W_ReadDirectory(wad_file, filename, &numfilelumps);
+
     // We must free any lumps being cached from the PWAD we're about to reload:
     for (i = reloadlump; i < numlumps; ++i)
     {
@@ -620,24 +874,155 @@ void W_Reload(void)
         }
     }
 
-    // Reset numlumps to remove the reload WAD file:
-    numlumps = reloadlump;
+    // Same lumps in the same order? Then lump numbers and hash chains
+    // stay valid, only positions and sizes need to be updated.
+    if (numfilelumps == (int) numlumps - reloadlump)
+    {
+        for (i = 0; i < numfilelumps; ++i)
+        {
+            if (strncasecmp(reloadlumps[i].name, fileinfo[i].name, 8))
+            {
+                break;
+            }
+        }
+    }
+    else
+    {
+        i = -1;
+    }
+
+    if (i == numfilelumps)
+    {
+        for (i = 0; i < numfilelumps; ++i)
+        {
+            lumpinfo_t *lump_p = &reloadlumps[i];
 
-    // Now reload the WAD file.
-    filename = reloadname;
+            lump_p->wad_file = wad_file;
+            lump_p->position = LONG(fileinfo[i].filepos);
+            lump_p->size = LONG(fileinfo[i].size);
 
-    W_CloseFile(reloadhandle);
-    free(reloadlumps);
+            // Texture definitions or patch headers are often edited
+            // without changing their size, so compare the contents.
+            if (!W_IsMapLump((const lumpinfo_t *const *) lumpinfo + reloadlump,
+                             numfilelumps, i))
+            {
+                sha1_digest_t sum;
 
-    reloadname = NULL;
-    reloadlump = -1;
-    reloadhandle = NULL;
-    W_AddFile(filename);
-    free(filename);
+                W_HashLump(lump_p, sum);
+
+                if (memcmp(sum, reloadsums[i], sizeof(sum)))
+                {
+                    memcpy(reloadsums[i], sum, sizeof(sum));
+                    result = W_RELOAD_RESOURCES;
+                }
+            }
+        }
+
+        W_CloseFile(reloadhandle);
+        reloadhandle = wad_file;
+    }
+    else
+    {
+        // Reset numlumps to remove the reload WAD file:
+        numlumps = reloadlump;
+
+        W_CloseFile(reloadhandle);
+        free(reloadlumps);
+
+        reloadhandle = wad_file;
+        reloadlumps = W_AddLumps(wad_file, fileinfo, numfilelumps);
+        W_HashReloadLumps();
+
+        // The WAD directory has changed, so we have to regenerate the
+        // fast lookup hashtable:
+        W_GenerateHashTable();
+
+        result = W_RELOAD_RESOURCES;
+    }
+
+    Z_Free(fileinfo);
+
+    return result;
+}
+
+// [JN] Reads pending inotify events, returns true if any of them
+// was about the reload file.
+
+#ifdef HAVE_INOTIFY
+static boolean W_ReadReloadEvents (void)
+{
+    char buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    const char *name = M_BaseName(reloadname + 1);
+    boolean result = false;
+    ssize_t len;
+    char *p;
+
+    while ((len = read(reloadwatch, buf, sizeof(buf))) > 0)
+    {
+        for (p = buf; p < buf + len;
+             p += sizeof(struct inotify_event) + ((struct inotify_event *) p)->len)
+        {
+            const struct inotify_event *event = (struct inotify_event *) p;
+
+            if ((event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+             && event->len > 0 && !strcmp(event->name, name))
+            {
+                result = true;
+            }
+        }
+    }
+
+    return result;
+}
+#endif
+
+// [JN] Called once per tic. Returns true when the reload file has been
+// written since it was last read, and it is safe to reload it. A write
+// reported by inotify is trusted as it is, stat() can't tell apart two
+// saves of the same size made within its time resolution. Without
+// inotify the file is checked once per given number of calls, and only
+// reported once it has stayed the same between two checks, so a file
+// that is still being written isn't read.
+
+boolean W_ReloadFileChanged(int pollinterval)
+{
+    reloadstat_t rs;
+    boolean settled;
+
+    if (reloadname == NULL)
+    {
+        return false;
+    }
+
+#ifdef HAVE_INOTIFY
+    if (reloadwatch >= 0)
+    {
+        if (!W_ReadReloadEvents())
+        {
+            return false;
+        }
+
+        reloadwritten = true;
+        return true;
+    }
+#endif
+
+    if (--reloadpoll > 0)
+    {
+        return false;
+    }
+
+    reloadpoll = pollinterval;
+
+    if (!W_StatReloadFile(&rs))
+    {
+        return false;
+    }
+
+    settled = W_SameReloadStat(&rs, &reloadseenstat);
+    reloadseenstat = rs;
 
-    // The WAD directory has changed, so we have to regenerate the
-    // fast lookup hashtable:
-    W_GenerateHashTable();
+    return settled && !W_SameReloadStat(&rs, &reloadstat);
 }
 
 const char *W_WadNameForLump(const lumpinfo_t *lump)
@@ -72,7 +72,13 @@ extern lumpinfo_t **lumpinfo;
 extern unsigned int numlumps;
 
 wad_file_t *W_AddFile(const char *filename);
-void W_Reload(void);
+// [JN] What W_Reload has found changed in the '~' reload file.
+#define W_RELOAD_NONE       0   // nothing, file hasn't been written to
+#define W_RELOAD_MAPS       1   // map lumps only
+#define W_RELOAD_RESOURCES  2   // other lumps may have changed as well
+
+int W_Reload(void);
+boolean W_ReloadFileChanged(int pollinterval);
 
 lumpindex_t W_CheckNumForName(const char *name);
 lumpindex_t W_GetNumForName(const char *name);
@@ -91,6 +97,8 @@ extern unsigned int W_LumpNameHash(const char *s);
 void W_ReleaseLumpNum(lumpindex_t lump);
 void W_ReleaseLumpName(const char *name);
 
+void W_PrefetchLumpNum(lumpindex_t lump);
+
 const char *W_WadNameForLump(const lumpinfo_t *lump);
 boolean W_IsIWADLump(const lumpinfo_t *lump);
 
@@ -37,11 +37,21 @@
 //
 // It is of no value to free a cachable block,
 //  because it will get overwritten automatically if needed.
+//
+// [JN] Besides the address ordered block list, every block is also
+//  on a second list: free blocks on a free list of their size class,
+//  used blocks on the list of their tag. Allocation looks at the
+//  free lists first and Z_FreeTags only visits blocks of the given
+//  tags. The rover walk is left as a fallback, when nothing fits
+//  without purging cachable blocks.
 // 
  
 #define MEM_ALIGN sizeof(void *)
 #define ZONEID	0x1d4a11
 
+// Free blocks of size class n are between 2^n and 2^(n+1)-1 bytes.
+#define NUMSIZECLASSES	32
+
 typedef struct memblock_s
 {
     int			size;	// including the header and possibly tiny fragments
@@ -50,6 +60,8 @@ typedef struct memblock_s
     int			id;	// should be ZONEID
     struct memblock_s*	next;
     struct memblock_s*	prev;
+    struct memblock_s*	listnext;	// free list or tag list
+    struct memblock_s*	listprev;
 } memblock_t;
 
 
@@ -62,6 +74,10 @@ typedef struct
     memblock_t	blocklist;
     
     memblock_t*	rover;
+
+    // start / end caps for free and tag lists
+    memblock_t	freelists[NUMSIZECLASSES];
+    memblock_t	taglists[PU_NUM_TAGS];
     
 } memzone_t;
 
@@ -72,6 +88,59 @@ static boolean zero_on_free;
 static boolean scan_on_free;
 
 
+static int Z_SizeClass (int size)
+{
+    int sizeclass = 0;
+
+    while (size > 1 && sizeclass < NUMSIZECLASSES - 1)
+    {
+        size >>= 1;
+        sizeclass++;
+    }
+
+    return sizeclass;
+}
+
+// Add a block to the end of a free list or tag list.
+
+static void Z_InsertBlock (memblock_t *list, memblock_t *block)
+{
+    block->listnext = list;
+    block->listprev = list->listprev;
+    list->listprev->listnext = block;
+    list->listprev = block;
+}
+
+static void Z_RemoveBlock (memblock_t *block)
+{
+    block->listprev->listnext = block->listnext;
+    block->listnext->listprev = block->listprev;
+}
+
+static void Z_InsertFreeBlock (memzone_t *zone, memblock_t *block)
+{
+    Z_InsertBlock(&zone->freelists[Z_SizeClass(block->size)], block);
+}
+
+static void Z_InitLists (memzone_t *zone)
+{
+    memblock_t *list;
+    int i;
+
+    for (i = 0; i < NUMSIZECLASSES; i++)
+    {
+        list = &zone->freelists[i];
+        list->listnext = list->listprev = list;
+    }
+
+    for (i = 0; i < PU_NUM_TAGS; i++)
+    {
+        list = &zone->taglists[i];
+        list->listnext = list->listprev = list;
+    }
+}
+
+
 //
 // Z_ClearZone
 //
@@ -94,6 +163,9 @@ void Z_ClearZone (memzone_t* zone)
     block->tag = PU_FREE;
 
     block->size = zone->size - sizeof(memzone_t);
+
+    Z_InitLists(zone);
+    Z_InsertFreeBlock(zone, block);
 }
 
 
@@ -125,6 +197,9 @@ void Z_Init (void)
 
     block->size = mainzone->size - sizeof(memzone_t);
 
+    Z_InitLists(mainzone);
+    Z_InsertFreeBlock(mainzone, block);
+
     // [Deliberately undocumented]
     // Zone memory debugging flag. If set, memory is zeroed after it is freed
     // to deliberately break any code that attempts to use it after free.
@@ -194,6 +269,11 @@ void Z_Free (void* ptr)
 	    *block->user = 0;
     }
 
+    if (block->tag != PU_FREE)
+    {
+        Z_RemoveBlock(block);
+    }
+
     // mark as free
     block->tag = PU_FREE;
     block->user = NULL;
@@ -216,6 +296,7 @@ void Z_Free (void* ptr)
     if (other->tag == PU_FREE)
     {
         // merge with previous free block
+        Z_RemoveBlock(other);
         other->size += block->size;
         other->next = block->next;
         other->next->prev = other;
@@ -230,6 +311,7 @@ void Z_Free (void* ptr)
     if (other->tag == PU_FREE)
     {
         // merge the next free block onto the end
+        Z_RemoveBlock(other);
         block->size += other->size;
         block->next = other->next;
         block->next->prev = block;
@@ -237,40 +319,58 @@ void Z_Free (void* ptr)
         if (other == mainzone->rover)
             mainzone->rover = block;
     }
+
+    Z_InsertFreeBlock(mainzone, block);
 }
 
 
 
 //
-// Z_Malloc
-// You can pass a NULL user if the tag is < PU_PURGELEVEL.
+// Z_FindFreeBlock
+// Returns a free block of at least size bytes, or NULL if
+// there is none without purging.
 //
-#define MINFRAGMENT		64
+static memblock_t *Z_FindFreeBlock (int size)
+{
+    memblock_t*	list;
+    memblock_t*	block;
+    int		sizeclass;
 
+    sizeclass = Z_SizeClass(size);
 
-void*
-Z_Malloc
-( int		size,
-  int		tag,
-  void*		user )
+    // blocks of the same class may still be too small
+    list = &mainzone->freelists[sizeclass];
+
+    for (block = list->listnext ; block != list ; block = block->listnext)
+    {
+        if (block->size >= size)
+            return block;
+    }
+
+    // any block of a larger class will do
+    for (sizeclass++ ; sizeclass < NUMSIZECLASSES ; sizeclass++)
+    {
+        list = &mainzone->freelists[sizeclass];
+
+        if (list->listnext != list)
+            return list->listnext;
+    }
+
+    return NULL;
+}
+
+
+//
+// Z_PurgeForBlock
+// Scans through the block list, looking for the first free block
+// of sufficient size, throwing out any purgable blocks along the way.
+//
+static memblock_t *Z_PurgeForBlock (int size)
 {
-    int		extra;
     memblock_t*	start;
     memblock_t* rover;
-    memblock_t* newblock;
     memblock_t*	base;
-    void *result;
-
-    size = (size + MEM_ALIGN - 1) & ~(MEM_ALIGN - 1);
-    
-    // scan through the block list,
-    // looking for the first free block
-    // of sufficient size,
-    // throwing out any purgable blocks along the way.
 
-    // account for size of block header
-    size += sizeof(memblock_t);
-    
     // if there is a free block behind the rover,
     //  back up over them
     base = mainzone->rover;
@@ -315,8 +415,44 @@ Z_Malloc
 
     } while (base->tag != PU_FREE || base->size < size);
 
+    return base;
+}
+
+
+
+//
+// Z_Malloc
+// You can pass a NULL user if the tag is < PU_PURGELEVEL.
+//
+#define MINFRAGMENT		64
+
+
+void*
+Z_Malloc
+( int		size,
+  int		tag,
+  void*		user )
+{
+    int		extra;
+    memblock_t* newblock;
+    memblock_t*	base;
+    void *result;
+
+    size = (size + MEM_ALIGN - 1) & ~(MEM_ALIGN - 1);
+
+    // account for size of block header
+    size += sizeof(memblock_t);
+
+    // [JN] Take a free block if there is one,
+    //  only purge when there is not.
+    base = Z_FindFreeBlock(size);
+
+    if (base == NULL)
+        base = Z_PurgeForBlock(size);
+
     
     // found a block big enough
+    Z_RemoveBlock(base);
     extra = base->size - size;
     
     if (extra >  MINFRAGMENT)
@@ -333,6 +469,8 @@ Z_Malloc
 
         base->next = newblock;
         base->size = size;
+
+        Z_InsertFreeBlock(mainzone, newblock);
     }
 	
 	if (user == NULL && tag >= PU_PURGELEVEL)
@@ -340,6 +478,7 @@ Z_Malloc
 
     base->user = user;
     base->tag = tag;
+    Z_InsertBlock(&mainzone->taglists[tag], base);
 
     result  = (void *) ((byte *)base + sizeof(memblock_t));
 
@@ -366,22 +505,28 @@ Z_FreeTags
 ( int		lowtag,
   int		hightag )
 {
+    memblock_t*	list;
     memblock_t*	block;
     memblock_t*	next;
-	
-    for (block = mainzone->blocklist.next ;
-	 block != &mainzone->blocklist ;
-	 block = next)
-    {
-	// get link before freeing
-	next = block->next;
+    int		tag;
 
-	// free block?
-	if (block->tag == PU_FREE)
+    // [JN] Only walk the lists of requested tags.
+    for (tag = lowtag < PU_STATIC ? PU_STATIC : lowtag ;
+	 tag <= hightag && tag < PU_NUM_TAGS ;
+	 tag++)
+    {
+	if (tag == PU_FREE)
 	    continue;
-	
-	if (block->tag >= lowtag && block->tag <= hightag)
+
+	list = &mainzone->taglists[tag];
+
+	for (block = list->listnext ; block != list ; block = next)
+	{
+	    // get link before freeing
+	    next = block->listnext;
+
 	    Z_Free ( (byte *)block+sizeof(memblock_t));
+	}
     }
 }
 
@@ -467,9 +612,17 @@ void Z_FileDumpHeap (FILE* f)
 void Z_CheckHeap (void)
 {
     memblock_t*	block;
+    memblock_t*	list;
+    int		numblocks;
+    int		listed;
+    int		i;
 	
+    numblocks = 0;
+
     for (block = mainzone->blocklist.next ; ; block = block->next)
     {
+	numblocks++;
+
 	if (block->next == &mainzone->blocklist)
 	{
 	    // all blocks have been hit
@@ -485,6 +638,45 @@ void Z_CheckHeap (void)
 	if (block->tag == PU_FREE && block->next->tag == PU_FREE)
 	    I_Error ("Z_CheckHeap: two consecutive free blocks\n");
     }
+
+    // [JN] Every block must be on exactly one free or tag list.
+    listed = 0;
+
+    for (i = 0 ; i < NUMSIZECLASSES ; i++)
+    {
+	list = &mainzone->freelists[i];
+
+	for (block = list->listnext ; block != list ; block = block->listnext)
+	{
+	    if (block->listnext->listprev != block)
+		I_Error ("Z_CheckHeap: free list doesn't have proper back link\n");
+
+	    if (block->tag != PU_FREE || Z_SizeClass(block->size) != i)
+		I_Error ("Z_CheckHeap: block on wrong free list\n");
+
+	    listed++;
+	}
+    }
+
+    for (i = 0 ; i < PU_NUM_TAGS ; i++)
+    {
+	list = &mainzone->taglists[i];
+
+	for (block = list->listnext ; block != list ; block = block->listnext)
+	{
+	    if (block->listnext->listprev != block)
+		I_Error ("Z_CheckHeap: tag list doesn't have proper back link\n");
+
+	    if (block->tag != i)
+		I_Error ("Z_CheckHeap: block on wrong tag list\n");
+
+	    listed++;
+	}
+    }
+
+    if (listed != numblocks)
+	I_Error ("Z_CheckHeap: %i blocks, but %i on free and tag lists\n",
+	         numblocks, listed);
 }
 
 
@@ -507,7 +699,9 @@ void Z_ChangeTag2(void *ptr, int tag, const char *file, int line)
         I_Error("%s:%i: Z_ChangeTag: an owner is required "
                 "for purgable blocks", file, line);
 
+    Z_RemoveBlock(block);
     block->tag = tag;
+    Z_InsertBlock(&mainzone->taglists[tag], block);
 }
 
 void Z_ChangeUser(void *ptr, void **user)